@@ -3,15 +3,94 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <functional>
 #include <algorithm>
 #include <ctime>
 #include <sstream>
 #include <iomanip>
 #include <limits>
-#include <conio.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <charconv>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <random>
+#include <memory>
+#include <bitset>
+#include <deque>
+#include <optional>
+#include <utility>
+#include <bit>
+#include <array>
+#include <cmath>
+#include <coroutine>
+#ifdef _WIN32
+#include <conio.h>      // _getch
+#define NOMINMAX        // Keep windows.h from defining min/max macros
+#include <windows.h>    // CreateFileMapping / MapViewOfFile
+#include <io.h>         // _commit
+#include <fcntl.h>      // _open
+#include <psapi.h>      // GetProcessMemoryInfo
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>     // fsync
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap
+#include <sys/stat.h>   // fstat
+#include <termios.h>    // _getch
+#include <sys/socket.h> // Kiosk server (Unix domain sockets)
+#include <sys/un.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <csignal>
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+#define X86_SIMD            // SSE2 / AVX2 kernels
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>         // __cpuid
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#endif
 
 using namespace std;
 
+#ifndef _WIN32
+// conio.h's _getch: one key press without echo, with Enter read as '\r'
+// and backspace as '\b' as on Windows (plain reads when not a terminal)
+int _getch() {
+    termios saved;
+    bool terminal = tcgetattr(STDIN_FILENO, &saved) == 0;
+    if (terminal) {
+        termios raw = saved;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    }
+    int ch = getchar();
+    if (terminal) tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    if (ch == '\n' || ch == EOF) return '\r';
+    if (ch == 127) return '\b';
+    return ch;
+}
+#endif
+
 /*
  * ===================================================================
  * FORWARD DECLARATIONS
@@ -19,6 +98,483 @@ using namespace std;
  */
 class Candidate; // Forward declaration for use in Party class
 
+/*
+ * ===================================================================
+ * DURABLE FILE REPLACEMENT
+ * A file is never rewritten in place: the new contents go to
+ * "<name>.tmp", which is synced to disk and then renamed over the old
+ * file. A crash leaves either the old or the new file, never a mix.
+ * ===================================================================
+ */
+
+// Flush a written file's data to the disk
+bool syncFile(const string& filename) {
+#ifdef _WIN32
+    int fd = _open(filename.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0) return false;
+    bool synced = _commit(fd) == 0;
+    _close(fd);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool synced = fsync(fd) == 0;
+    ::close(fd);
+#endif
+    return synced;
+}
+
+// Temporary name to write a new version of 'filename' to
+string temporaryFile(const string& filename) {
+    return filename + ".tmp";
+}
+
+// Sync the finished temporary file and rename it over 'filename'
+bool commitFile(const string& filename) {
+    string temporary = temporaryFile(filename);
+    if (!syncFile(temporary)) return false;
+    error_code error;
+    filesystem::rename(temporary, filename, error);
+    if (error) return false;
+#ifndef _WIN32
+    // Make the rename itself durable
+    string directory = filesystem::path(filename).parent_path().string();
+    int fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+#endif
+    return true;
+}
+
+// Replace 'filename' with 'contents' (temporary file, sync, rename)
+bool writeFile(const string& filename, const string& contents) {
+    ofstream file(temporaryFile(filename), ios::binary | ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(contents.data(), contents.size());
+    file.close();
+    return !file.fail() && commitFile(filename);
+}
+
+/*
+ * ===================================================================
+ * FIELD TOKENIZER - splits a record into fields without copying
+ * Each field is a string_view into the original line, so parsing a
+ * record only allocates when a field is stored in an owned string.
+ * ===================================================================
+ */
+class FieldTokenizer {
+private:
+    string_view rest;
+    char delimiter;
+    bool finished;
+
+public:
+    FieldTokenizer(string_view text, char delim = ',') 
+        : rest(text), delimiter(delim), finished(false) {}
+    
+    // Next field, or an empty view once the text is used up
+    string_view next() {
+        if (finished) return string_view();
+        size_t pos = rest.find(delimiter);
+        string_view field = rest.substr(0, pos);
+        if (pos == string_view::npos) {
+            finished = true;
+            rest = string_view();
+        } else {
+            rest.remove_prefix(pos + 1);
+        }
+        return field;
+    }
+    
+    bool hasMore() const { return !finished; }
+};
+
+/*
+ * ===================================================================
+ * ATOMIC FIELDS - thread-safe counters and flags inside records
+ * std::atomic cannot be copied, but records live in vectors and are
+ * copied when loading or building reports, so these wrappers copy the
+ * current value. PaddedCounter sits on its own cache line so threads
+ * voting for different candidates never share one (no false sharing).
+ * ===================================================================
+ */
+template<typename V>
+class CopyableAtomic : public atomic<V> {
+public:
+    CopyableAtomic(V value = V()) : atomic<V>(value) {}
+    CopyableAtomic(const CopyableAtomic& other) : atomic<V>(other.load(memory_order_relaxed)) {}
+    CopyableAtomic& operator=(const CopyableAtomic& other) {
+        this->store(other.load(memory_order_relaxed), memory_order_relaxed);
+        return *this;
+    }
+    CopyableAtomic& operator=(V value) {
+        this->store(value, memory_order_relaxed);
+        return *this;
+    }
+};
+
+struct alignas(64) PaddedCounter {
+    CopyableAtomic<int> value;
+    
+    PaddedCounter(int v = 0) : value(v) {}
+    int get() const { return value.load(memory_order_relaxed); }
+    void set(int v) { value.store(v, memory_order_relaxed); }
+    void increment() { value.fetch_add(1, memory_order_relaxed); }
+};
+
+// Parse an integer field without building a string; false (and 'value'
+// unchanged) unless the whole field is a number in range
+template<typename Integer>
+bool parseNumber(string_view text, Integer& value) {
+    Integer parsed;
+    auto result = from_chars(text.data(), text.data() + text.size(), parsed);
+    if (text.empty() || result.ec != errc() || result.ptr != text.data() + text.size()) return false;
+    value = parsed;
+    return true;
+}
+
+/*
+ * ===================================================================
+ * PARALLEL HELPERS - shared by the loaders, ballot import and reports
+ * ===================================================================
+ */
+
+// Run task(0) ... task(taskCount - 1) on up to 'threadCount' threads
+// (0 = one per core). Tasks are handed out one at a time, so uneven
+// tasks still keep every thread busy; the calling thread works too.
+void runParallel(size_t taskCount, unsigned threadCount, const function<void(size_t)>& task) {
+    if (threadCount == 0) threadCount = max(1u, thread::hardware_concurrency());
+    atomic<size_t> nextTask(0);
+    auto worker = [&]() {
+        size_t t;
+        while ((t = nextTask.fetch_add(1)) < taskCount) {
+            task(t);
+        }
+    };
+    vector<thread> pool;
+    for (size_t t = 1; t < min((size_t)threadCount, taskCount); t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : pool) {
+        t.join();
+    }
+}
+
+// Read a whole file into 'buffer' in one go
+bool readWholeFile(const string& filename, string& buffer) {
+    ifstream file(filename, ios::binary | ios::ate);
+    if (!file.is_open()) return false;
+    buffer.assign((size_t)file.tellg(), '\0');
+    file.seekg(0);
+    file.read(&buffer[0], buffer.size());
+    return true;
+}
+
+// Split a text buffer into newline-aligned chunks for parallel parsing and
+// return the boundaries (chunk c is [bounds[c], bounds[c + 1])). A few
+// chunks per thread keeps the workers busy when chunks are uneven; small
+// buffers become a single chunk.
+vector<size_t> splitAtNewlines(const string& buffer, unsigned threadCount) {
+    if (threadCount == 0) threadCount = max(1u, thread::hardware_concurrency());
+    const size_t minChunkBytes = 256 * 1024;
+    size_t chunkCount = min((size_t)threadCount * 4, buffer.size() / minChunkBytes + 1);
+    
+    vector<size_t> bounds(1, 0);
+    for (size_t c = 1; c < chunkCount; c++) {
+        size_t pos = buffer.find('\n', buffer.size() * c / chunkCount);
+        if (pos == string::npos) break;
+        if (pos + 1 > bounds.back()) bounds.push_back(pos + 1);
+    }
+    bounds.push_back(buffer.size());
+    return bounds;
+}
+
+// Call onLine(line) for every non-empty line in buffer[begin, end)
+// ('\r' of Windows line endings removed)
+template<typename LineHandler>
+void forEachLine(string_view buffer, size_t begin, size_t end, LineHandler onLine) {
+    string_view text(buffer);
+    while (begin < end) {
+        size_t newline = buffer.find('\n', begin);
+        if (newline == string_view::npos || newline > end) newline = end;
+        size_t length = newline - begin;
+        if (length > 0 && buffer[begin + length - 1] == '\r') length--;
+        if (length > 0) {
+            onLine(text.substr(begin, length));
+        }
+        begin = newline + 1;
+    }
+}
+
+/*
+ * ===================================================================
+ * SIMD DISPATCH - the vector instruction set used by the bulk kernels
+ * (CNIC packing, delimiter scanning) is chosen once at startup from
+ * the processor; SSE2 is part of every x86-64 processor and the scalar
+ * loops cover everything else.
+ * ===================================================================
+ */
+enum class SimdKernel { SCALAR, SSE2, AVX2 };
+
+const char* simdKernelName(SimdKernel kernel) {
+    switch (kernel) {
+        case SimdKernel::AVX2: return "AVX2";
+        case SimdKernel::SSE2: return "SSE2";
+        default: return "scalar";
+    }
+}
+
+// Fastest kernel this processor runs
+SimdKernel detectSimdKernel() {
+#ifdef X86_SIMD
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    if (osSavesYmm && (info[1] & (1 << 5)) != 0) return SimdKernel::AVX2;
+#else
+    if (__builtin_cpu_supports("avx2")) return SimdKernel::AVX2;
+#endif
+    return SimdKernel::SSE2;
+#else
+    return SimdKernel::SCALAR;
+#endif
+}
+
+const SimdKernel bestSimdKernel = detectSimdKernel();
+
+/*
+ * ===================================================================
+ * DELIMITER SCANNER - structural index of a text table
+ * One pass finds every ',' ';' and '\n' of a block of text and records
+ * their offsets; the record builders then take their fields from this
+ * index instead of searching for each delimiter byte by byte. The
+ * vector kernels test 64 bytes at a time, turn the matches into a
+ * 64-bit mask and write the offsets of its set bits eight at a time.
+ * Text is scanned in windows small enough to stay in the CPU cache.
+ * ===================================================================
+ */
+const size_t SCAN_WINDOW_BYTES = 32 * 1024;
+
+// Write base + i for every set bit i of 'mask' to out[0..]; returns the
+// number of bits. Whole groups of eight are written, so up to seven
+// entries past the count are overwritten with scratch values.
+inline size_t flattenMask(uint64_t mask, uint32_t base, uint32_t* out) {
+    size_t count = (size_t)popcount(mask);
+    for (size_t written = 0; written < count; written += 8) {
+        for (int k = 0; k < 8; k++) {
+            out[written + k] = base + (uint32_t)countr_zero(mask | 1ULL << 63); // Bit 63 spares a zero check
+            mask &= mask - 1;
+        }
+    }
+    return count;
+}
+
+size_t scanDelimitersScalar(const char* text, size_t length, uint32_t* positions) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; i++) {
+        char c = text[i];
+        positions[count] = (uint32_t)i; // Kept only when c is a delimiter
+        count += (c == ',') | (c == ';') | (c == '\n');
+    }
+    return count;
+}
+
+#ifdef X86_SIMD
+inline uint64_t delimiterMaskSse2(const char* block) {
+    const __m128i comma = _mm_set1_epi8(','), semicolon = _mm_set1_epi8(';'), newline = _mm_set1_epi8('\n');
+    uint64_t mask = 0;
+    for (int k = 0; k < 4; k++) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(block + 16 * k));
+        __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, semicolon)), 
+                                     _mm_cmpeq_epi8(bytes, newline));
+        mask |= (uint64_t)(uint32_t)_mm_movemask_epi8(found) << (16 * k);
+    }
+    return mask;
+}
+
+// ',' (0x2C), ';' (0x3B) and '\n' (0x0A) have different low nibbles, so
+// one shuffle looks up the only delimiter each byte could be and one
+// compare tests it. The other entries can never match (and bytes with
+// the high bit set look up 0).
+TARGET_AVX2 inline uint64_t delimiterMaskAvx2(const char* block) {
+    const __m256i table = _mm256_setr_epi8(1, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\n', ';', ',', 0, 0, 0,
+                                           1, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\n', ';', ',', 0, 0, 0);
+    __m256i low = _mm256_loadu_si256((const __m256i*)block);
+    __m256i high = _mm256_loadu_si256((const __m256i*)(block + 32));
+    uint32_t lowMask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_shuffle_epi8(table, low), low));
+    uint32_t highMask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_shuffle_epi8(table, high), high));
+    return (uint64_t)highMask << 32 | lowMask;
+}
+
+// The last partial block is copied into a zero-filled block (NUL is not
+// a delimiter), so no kernel reads past the text
+size_t scanDelimitersSse2(const char* text, size_t length, uint32_t* positions) {
+    size_t count = 0, i = 0;
+    for (; i + 64 <= length; i += 64) {
+        count += flattenMask(delimiterMaskSse2(text + i), (uint32_t)i, positions + count);
+    }
+    if (i < length) {
+        char block[64] = {};
+        memcpy(block, text + i, length - i);
+        count += flattenMask(delimiterMaskSse2(block), (uint32_t)i, positions + count);
+    }
+    return count;
+}
+
+TARGET_AVX2 size_t scanDelimitersAvx2(const char* text, size_t length, uint32_t* positions) {
+    size_t count = 0, i = 0;
+    for (; i + 64 <= length; i += 64) {
+        count += flattenMask(delimiterMaskAvx2(text + i), (uint32_t)i, positions + count);
+    }
+    if (i < length) {
+        char block[64] = {};
+        memcpy(block, text + i, length - i);
+        count += flattenMask(delimiterMaskAvx2(block), (uint32_t)i, positions + count);
+    }
+    return count;
+}
+#endif
+
+// Offsets of every ',' ';' and '\n' in text[0, length), in order; returns
+// how many were found. 'positions' needs room for length + 8 entries.
+size_t scanDelimiters(const char* text, size_t length, uint32_t* positions, SimdKernel kernel = bestSimdKernel) {
+#ifdef X86_SIMD
+    if (kernel == SimdKernel::AVX2) return scanDelimitersAvx2(text, length, positions);
+    if (kernel == SimdKernel::SSE2) return scanDelimitersSse2(text, length, positions);
+#endif
+    return scanDelimitersScalar(text, length, positions);
+}
+
+// Cursor over the lines of a scanned window and their comma-separated
+// fields, read from the structural index: a record builder calls next()
+// for the fields of the current line, which are the fields
+// FieldTokenizer(line) returns. ';' entries are skipped and stay inside
+// their field (e.g. a party's candidate list).
+class IndexedFields {
+private:
+    const char* text;               // Start of the window
+    const uint32_t* delimiter;      // Next index entry
+    const uint32_t* lastDelimiter;
+    uint32_t fieldStart;            // Offset of the next field
+    uint32_t textEnd;               // End of the complete lines of the window
+    bool lineDone;
+    
+    // The current line has no text ("" or "\r")
+    bool atEmptyLine() const {
+        bool lineEndsHere = delimiter == lastDelimiter || text[*delimiter] == '\n';
+        uint32_t lineEnd = delimiter == lastDelimiter ? textEnd : *delimiter;
+        return lineEndsHere && (lineEnd == fieldStart || (lineEnd == fieldStart + 1 && text[fieldStart] == '\r'));
+    }
+
+public:
+    IndexedFields(const char* windowText, const uint32_t* first, const uint32_t* last, uint32_t end)
+        : text(windowText), delimiter(first), lastDelimiter(last), fieldStart(0), textEnd(end), lineDone(true) {}
+    
+    // Move to the next non-empty line; false after the last one
+    bool nextLine() {
+        while (!lineDone) next(); // Fields the record builder did not read
+        while (fieldStart < textEnd) {
+            lineDone = false;
+            if (!atEmptyLine()) return true;
+            next();
+        }
+        return false;
+    }
+    
+    // Next field, or an empty view once the line is used up
+    string_view next() {
+        if (lineDone) return string_view();
+        while (delimiter != lastDelimiter && text[*delimiter] == ';') delimiter++;
+        uint32_t stop = textEnd; // A final line without a '\n' ends with the text
+        if (delimiter != lastDelimiter) {
+            stop = *delimiter++;
+            lineDone = text[stop] == '\n';
+        } else {
+            lineDone = true;
+        }
+        uint32_t fieldEnd = stop;
+        if (lineDone && fieldEnd > fieldStart && text[fieldEnd - 1] == '\r') fieldEnd--;
+        string_view field(text + fieldStart, fieldEnd - fieldStart);
+        fieldStart = stop + 1;
+        return field;
+    }
+    
+    bool hasMore() const { return !lineDone; }
+};
+
+// Call onRecord(fields) for every non-empty line in buffer[begin, end)
+// ('\r' of Windows line endings removed) - forEachLine for record
+// builders. A window ends after its last '\n' and the unfinished line
+// starts the next window; a line longer than a window doubles it.
+template<typename RecordHandler>
+void forEachRecord(string_view buffer, size_t begin, size_t end, RecordHandler onRecord, 
+                   SimdKernel kernel = bestSimdKernel) {
+    size_t windowBytes = SCAN_WINDOW_BYTES;
+    vector<uint32_t> positions;
+    while (begin < end) {
+        size_t length = min(windowBytes, end - begin);
+        if (positions.size() < length + 8) positions.resize(length + 8);
+        const char* text = buffer.data() + begin;
+        size_t count = scanDelimiters(text, length, positions.data(), kernel);
+        
+        uint32_t textEnd = (uint32_t)length;
+        if (begin + length < end) {
+            while (count > 0 && text[positions[count - 1]] != '\n') count--;
+            if (count == 0) {
+                windowBytes *= 2;
+                continue;
+            }
+            textEnd = positions[count - 1] + 1;
+        }
+        IndexedFields fields(text, positions.data(), positions.data() + count, textEnd);
+        while (fields.nextLine()) {
+            onRecord(fields);
+        }
+        begin += textEnd;
+    }
+}
+
+/*
+ * ===================================================================
+ * BINARY SNAPSHOT RECORD - read-only view of one fixed-width record
+ * Each record is a row of (offset, length) references into a shared
+ * string heap followed by 64-bit integer columns. The view reads the
+ * bytes in place (e.g. straight from a memory-mapped file).
+ * ===================================================================
+ */
+struct SnapshotStringRef {
+    uint32_t offset; // Position of the text inside the string heap
+    uint32_t length;
+};
+
+class SnapshotRecord {
+private:
+    const char* row;   // Start of this record
+    int stringFields;  // Number of string columns before the integers
+    const char* heap;  // Start of the string heap
+
+public:
+    SnapshotRecord(const char* r, int strings, const char* h) 
+        : row(r), stringFields(strings), heap(h) {}
+    
+    string_view getString(int field) const {
+        SnapshotStringRef ref;
+        memcpy(&ref, row + field * sizeof(SnapshotStringRef), sizeof(ref));
+        return string_view(heap + ref.offset, ref.length);
+    }
+    
+    long long getInt(int field) const {
+        int64_t value;
+        memcpy(&value, row + stringFields * sizeof(SnapshotStringRef) + field * sizeof(int64_t), 
+               sizeof(value));
+        return value;
+    }
+};
+
 /*
  * ===================================================================
  * PARTY CLASS - Represents a political party
@@ -32,7 +588,7 @@ private:
     string partySymbol;
     string manifesto;
     vector<string> candidateIds; // Stores IDs of candidates belonging to this party
-    int totalVotes; // Total votes received by all party candidates
+    PaddedCounter totalVotes; // Total votes received by all party candidates (thread-safe)
 
 public:
     // Default constructor - needed for file operations
@@ -44,15 +600,18 @@ public:
     
     // GETTER METHODS - OOP CONCEPT: Encapsulation (Data hiding)
     // These methods provide controlled access to private data members
-    string getId() const { return partyId; }
-    string getName() const { return partyName; }
+    const string& getId() const { return partyId; }
+    const string& getName() const { return partyName; }
     string getSymbol() const { return partySymbol; }
     string getManifesto() const { return manifesto; }
-    int getTotalVotes() const { return totalVotes; }
+    int getTotalVotes() const { return totalVotes.get(); }
     vector<string> getCandidateIds() const { return candidateIds; }
     
     // SETTER METHODS - OOP CONCEPT: Encapsulation
-    void setTotalVotes(int votes) { totalVotes = votes; }
+    void setTotalVotes(int votes) { totalVotes.set(votes); }
+    
+    // Count one vote for a party candidate - safe to call from many threads
+    void addVote() { totalVotes.increment(); }
     
     // Method to add a candidate to this party - COMPOSITION relationship
     void addCandidate(const string& candidateId) {
@@ -82,30 +641,68 @@ public:
             if (i < candidateIds.size() - 1) candidateList += ";";
         }
         return partyId + "," + partyName + "," + partySymbol + "," + 
-               manifesto + "," + to_string(totalVotes) + "," + candidateList;
+               manifesto + "," + to_string(totalVotes.get()) + "," + candidateList;
+    }
+    
+    // Binary snapshot layout: 5 strings + 1 integer
+    static const int SNAPSHOT_STRINGS = 5;
+    static const int SNAPSHOT_INTS = 1;
+    
+    void toSnapshot(vector<string>& strings, vector<long long>& ints) const {
+        string candidateList = "";
+        for (size_t i = 0; i < candidateIds.size(); i++) {
+            candidateList += candidateIds[i];
+            if (i < candidateIds.size() - 1) candidateList += ";";
+        }
+        strings = {partyId, partyName, partySymbol, manifesto, candidateList};
+        ints = {totalVotes.get()};
     }
     
-    void fromString(const string& str) {
-        stringstream ss(str);
-        string token;
+    void fromSnapshot(const SnapshotRecord& record) {
+        partyId = string(record.getString(0));
+        partyName = string(record.getString(1));
+        partySymbol = string(record.getString(2));
+        manifesto = string(record.getString(3));
+        totalVotes.set((int)record.getInt(0));
         
-        getline(ss, partyId, ',');
-        getline(ss, partyName, ',');
-        getline(ss, partySymbol, ',');
-        getline(ss, manifesto, ',');
-        getline(ss, token, ',');
-        totalVotes = stoi(token);
+        candidateIds.clear();
+        string_view list = record.getString(4);
+        while (!list.empty()) {
+            size_t semicolon = list.find(';');
+            candidateIds.push_back(string(list.substr(0, semicolon)));
+            if (semicolon == string_view::npos) break;
+            list.remove_prefix(semicolon + 1);
+        }
+    }
+    
+    // False if a numeric field is not a number
+    bool fromString(string_view str) {
+        FieldTokenizer fields(str);
+        return fromFields(fields);
+    }
+    
+    // Fields from a FieldTokenizer or from the structural index (IndexedFields)
+    template<typename Fields>
+    bool fromFields(Fields& fields) {
+        partyId.assign(fields.next());
+        partyName.assign(fields.next());
+        partySymbol.assign(fields.next());
+        manifesto.assign(fields.next());
+        int votes = 0;
+        if (!parseNumber(fields.next(), votes)) return false;
+        totalVotes.set(votes);
         
         // Parse candidate IDs
         candidateIds.clear();
-        getline(ss, token, ',');
-        if (!token.empty()) {
-            stringstream candidateStream(token);
-            string candidateId;
-            while (getline(candidateStream, candidateId, ';')) {
-                candidateIds.push_back(candidateId);
+        string_view list = fields.next();
+        if (!list.empty()) {
+            candidateIds.reserve(count(list.begin(), list.end(), ';') + 1);
+            FieldTokenizer ids(list, ';');
+            while (ids.hasMore()) {
+                candidateIds.emplace_back(ids.next());
             }
         }
+        return true;
     }
 };
 
@@ -131,9 +728,16 @@ public:
     // OOP CONCEPT: Virtual destructor - ensures proper cleanup in inheritance
     virtual ~User() {}
     
+    // Declaring the destructor suppresses the implicit move operations,
+    // so bring them back - voters are moved (not copied) when vectors grow
+    User(const User&) = default;
+    User(User&&) = default;
+    User& operator=(const User&) = default;
+    User& operator=(User&&) = default;
+    
     // OOP CONCEPT: Pure virtual function - makes this an abstract class
     // This MUST be implemented by derived classes (Polymorphism)
-    virtual void displayMenu() = 0;
+    virtual void displayMenu(ostream& out) = 0;
     
     // OOP CONCEPT: Virtual function - can be overridden in derived classes
     virtual bool authenticate(string un, string pw) {
@@ -159,10 +763,79 @@ class DataManager {
 private:
     vector<T> data; // DATA STRUCTURE: Vector (dynamic array)
     
+    // DATA STRUCTURE: Hash index - maps a unique key (ID, CNIC, username...)
+    // to the position of the item in 'data'. Positions are stored instead of
+    // pointers because the vector may reallocate when it grows.
+    struct Index {
+        function<string(const T&)> keyOf; // Extracts the key from an item
+        unordered_map<string, size_t> positions;
+    };
+    map<string, Index> indexes; // Declared indexes by name
+    
+    // Dirty flags: records changed since the last save. Set from voting
+    // threads, so they are atomic; records past the end count as dirty.
+    vector<CopyableAtomic<bool>> dirty;
+    
+    // Register one item in every declared index (first item with a key wins)
+    void indexItem(size_t position) {
+        for (auto& entry : indexes) {
+            Index& index = entry.second;
+            index.positions.emplace(index.keyOf(data[position]), position);
+        }
+    }
+    
 public:
+    // Declare a unique hash index, e.g. addIndex("cnic", &Voter::getCnic)
+    void addIndex(const string& indexName, function<string(const T&)> keyOf) {
+        Index& index = indexes[indexName];
+        index.keyOf = keyOf;
+        index.positions.clear();
+        index.positions.reserve(data.size());
+        for (size_t i = 0; i < data.size(); i++) {
+            index.positions.emplace(index.keyOf(data[i]), i);
+        }
+    }
+    
+    // Rebuild all indexes - needed after the vector is filled directly
+    // (e.g. by FileHandler<T>::loadFromFile through getAllData())
+    void rebuildIndexes() {
+        for (auto& entry : indexes) {
+            entry.second.positions.clear();
+            entry.second.positions.reserve(data.size());
+        }
+        for (size_t i = 0; i < data.size(); i++) {
+            indexItem(i);
+        }
+    }
+    
     // Add an item to the collection
     void addData(const T& item) {
         data.push_back(item); // Vector method to add at end
+        indexItem(data.size() - 1);
+        markDirty(data.size() - 1);
+    }
+    
+    // Record that the item at 'position' changed since the last save
+    void markDirty(size_t position) {
+        if (position >= dirty.size()) {
+            dirty.resize(data.size(), CopyableAtomic<bool>(true));
+        } else if (!dirty[position].load(memory_order_relaxed)) {
+            dirty[position].store(true, memory_order_relaxed);
+        }
+    }
+    
+    // Any changed item in [first, last)?
+    bool isRangeDirty(size_t first, size_t last) const {
+        if (last > dirty.size()) return true;
+        for (size_t i = first; i < last; i++) {
+            if (dirty[i].load(memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+    
+    // Everything matches the files (after loading or saving)
+    void markAllClean() {
+        dirty.assign(data.size(), CopyableAtomic<bool>(false));
     }
     
     // Get reference to all data (allows modification)
@@ -173,6 +846,10 @@ public:
     // Clear all data
     void clearData() {
         data.clear(); // Vector method to remove all elements
+        dirty.clear();
+        for (auto& entry : indexes) {
+            entry.second.positions.clear();
+        }
     }
     
     // Get number of items
@@ -199,6 +876,24 @@ public:
         }
         return nullptr;
     }
+    
+    // Find item through a declared hash index - O(1) on average
+    T* findItem(const string& indexName, const string& key) {
+        auto indexIt = indexes.find(indexName);
+        if (indexIt == indexes.end()) {
+            throw invalid_argument("Unknown index: " + indexName);
+        }
+        auto it = indexIt->second.positions.find(key);
+        if (it == indexIt->second.positions.end()) {
+            return nullptr;
+        }
+        return &data[it->second];
+    }
+    
+    // Check whether a key is present in a declared index
+    bool containsKey(const string& indexName, const string& key) {
+        return findItem(indexName, key) != nullptr;
+    }
 };
 
 /*
@@ -214,7 +909,7 @@ private:
     string cnic; // Added CNIC for Pakistani system
     string partyId; // Reference to party (AGGREGATION - candidate belongs to party)
     string manifesto;
-    int votes;
+    PaddedCounter votes; // Thread-safe vote tally
     bool isIndependent; // Flag to check if candidate is independent
 
 public:
@@ -231,12 +926,12 @@ public:
           votes(0), isIndependent(false) {}
     
     // GETTER METHODS - OOP CONCEPT: Encapsulation
-    string getId() const { return candidateId; }
-    string getName() const { return name; }
+    const string& getId() const { return candidateId; }
+    const string& getName() const { return name; }
     string getCnic() const { return cnic; }
-    string getPartyId() const { return partyId; }
+    const string& getPartyId() const { return partyId; }
     string getManifesto() const { return manifesto; }
-    int getVotes() const { return votes; }
+    int getVotes() const { return votes.get(); }
     bool getIsIndependent() const { return isIndependent; }
     
     // SETTER METHODS
@@ -245,9 +940,9 @@ public:
         isIndependent = pId.empty();
     }
     
-    // Increment votes
-    void addVote() { votes++; }
-    void setVotes(int v) { votes = v; }
+    // Increment votes - safe to call from many threads
+    void addVote() { votes.increment(); }
+    void setVotes(int v) { votes.set(v); }
     
     // Check if candidate belongs to a specific party
     bool belongsToParty(const string& pId) const {
@@ -257,22 +952,46 @@ public:
     // File I/O methods for data persistence
     string toString() const {
         return candidateId + "," + name + "," + cnic + "," + partyId + "," + 
-               manifesto + "," + to_string(votes) + "," + (isIndependent ? "1" : "0");
+               manifesto + "," + to_string(votes.get()) + "," + (isIndependent ? "1" : "0");
     }
     
-    void fromString(const string& str) {
-        stringstream ss(str);
-        string token;
-        
-        getline(ss, candidateId, ',');
-        getline(ss, name, ',');
-        getline(ss, cnic, ',');
-        getline(ss, partyId, ',');
-        getline(ss, manifesto, ',');
-        getline(ss, token, ',');
-        votes = stoi(token);
-        getline(ss, token, ',');
-        isIndependent = (token == "1");
+    // Binary snapshot layout: 5 strings + 2 integers
+    static const int SNAPSHOT_STRINGS = 5;
+    static const int SNAPSHOT_INTS = 2;
+    
+    void toSnapshot(vector<string>& strings, vector<long long>& ints) const {
+        strings = {candidateId, name, cnic, partyId, manifesto};
+        ints = {votes.get(), isIndependent ? 1 : 0};
+    }
+    
+    void fromSnapshot(const SnapshotRecord& record) {
+        candidateId = string(record.getString(0));
+        name = string(record.getString(1));
+        cnic = string(record.getString(2));
+        partyId = string(record.getString(3));
+        manifesto = string(record.getString(4));
+        votes.set((int)record.getInt(0));
+        isIndependent = record.getInt(1) != 0;
+    }
+    
+    // False if a numeric field is not a number
+    bool fromString(string_view str) {
+        FieldTokenizer fields(str);
+        return fromFields(fields);
+    }
+    
+    template<typename Fields>
+    bool fromFields(Fields& fields) {
+        candidateId.assign(fields.next());
+        name.assign(fields.next());
+        cnic.assign(fields.next());
+        partyId.assign(fields.next());
+        manifesto.assign(fields.next());
+        int count = 0;
+        if (!parseNumber(fields.next(), count)) return false;
+        votes.set(count);
+        isIndependent = (fields.next() == "1");
+        return true;
     }
 };
 
@@ -284,57 +1003,92 @@ public:
  */
 class Voter : public User { // OOP CONCEPT: Public inheritance
 private:
-    bool hasVoted;
+    // Vote state is claimed with an atomic compare-and-set, so two threads
+    // can never both record a vote for the same voter
+    enum VoteState { NOT_VOTED = 0, RECORDING = 1, VOTED = 2 };
+    CopyableAtomic<int> voteState;
     string votedFor;
 
 public:
     // Default constructor for file operations
-    Voter() : User("", "", "", "", ""), hasVoted(false), votedFor("") {}
+    Voter() : User("", "", "", "", ""), voteState(NOT_VOTED), votedFor("") {}
     
     // Parameterized constructor - calls base class constructor
     Voter(string un, string pw, string n, string i, string c) 
-        : User(un, pw, n, i, c), hasVoted(false), votedFor("") {}
+        : User(un, pw, n, i, c), voteState(NOT_VOTED), votedFor("") {}
     
     // OOP CONCEPT: Method overriding - implementing pure virtual function
-    void displayMenu() override {
-        cout << "\n=== VOTER MENU ===" << endl;
-        cout << "Welcome, " << name << " (CNIC: " << cnic << ")" << endl;
-        cout << "1. View Candidates" << endl;
-        cout << "2. View Parties" << endl;
-        cout << "3. Cast Vote" << endl;
-        cout << "4. Check Voting Status" << endl;
-        cout << "5. Logout" << endl;
-        cout << "=================" << endl;
+    void displayMenu(ostream& out) override {
+        out << "\n=== VOTER MENU ===" << endl;
+        out << "Welcome, " << name << " (CNIC: " << cnic << ")" << endl;
+        out << "1. View Candidates" << endl;
+        out << "2. View Parties" << endl;
+        out << "3. Cast Vote" << endl;
+        out << "4. Check Voting Status" << endl;
+        out << "5. Logout" << endl;
+        out << "=================" << endl;
     }
     
     // GETTER METHODS
-    bool getHasVoted() const { return hasVoted; }
-    string getVotedFor() const { return votedFor; }
+    bool getHasVoted() const { return voteState.load(memory_order_acquire) != NOT_VOTED; }
+    string getVotedFor() const { 
+        return voteState.load(memory_order_acquire) == VOTED ? votedFor : ""; 
+    }
     
-    // Cast vote method
-    void castVote(string candidateId) {
-        hasVoted = true;
+    // Cast vote method - returns false if this voter has already voted.
+    // Only the thread that wins the compare-and-set writes 'votedFor'.
+    bool castVote(const string& candidateId) {
+        int expected = NOT_VOTED;
+        if (!voteState.compare_exchange_strong(expected, RECORDING, memory_order_acq_rel)) {
+            return false;
+        }
         votedFor = candidateId;
+        voteState.store(VOTED, memory_order_release);
+        return true;
     }
     
     // File I/O methods
     string toString() const {
         return username + "," + password + "," + name + "," + id + "," + cnic + "," +
-               (hasVoted ? "1" : "0") + "," + votedFor;
+               (getHasVoted() ? "1" : "0") + "," + votedFor;
     }
     
-    void fromString(const string& str) {
-        stringstream ss(str);
-        string token;
-        
-        getline(ss, username, ',');
-        getline(ss, password, ',');
-        getline(ss, name, ',');
-        getline(ss, id, ',');
-        getline(ss, cnic, ',');
-        getline(ss, token, ',');
-        hasVoted = (token == "1");
-        getline(ss, votedFor, ',');
+    // Binary snapshot layout: 6 strings + 1 integer
+    static const int SNAPSHOT_STRINGS = 6;
+    static const int SNAPSHOT_INTS = 1;
+    
+    void toSnapshot(vector<string>& strings, vector<long long>& ints) const {
+        strings = {username, password, name, id, cnic, votedFor};
+        ints = {getHasVoted() ? 1 : 0};
+    }
+    
+    void fromSnapshot(const SnapshotRecord& record) {
+        username = string(record.getString(0));
+        password = string(record.getString(1));
+        name = string(record.getString(2));
+        id = string(record.getString(3));
+        cnic = string(record.getString(4));
+        votedFor = string(record.getString(5));
+        voteState = record.getInt(0) != 0 ? VOTED : NOT_VOTED;
+    }
+    
+    bool fromString(string_view str) {
+        FieldTokenizer fields(str);
+        return fromFields(fields);
+    }
+    
+    // Always true: a voter has no numeric fields (same interface as the
+    // other records)
+    template<typename Fields>
+    bool fromFields(Fields& fields) {
+        username.assign(fields.next());
+        password.assign(fields.next());
+        name.assign(fields.next());
+        id.assign(fields.next());
+        cnic.assign(fields.next());
+        voteState = (fields.next() == "1") ? VOTED : NOT_VOTED;
+        votedFor.assign(fields.next());
+        return true;
     }
 };
 
@@ -350,19 +1104,22 @@ public:
     Admin(string un, string pw, string n, string i, string c) : User(un, pw, n, i, c) {}
     
     // OOP CONCEPT: Method overriding - implementing pure virtual function
-    void displayMenu() override {
-        cout << "\n=== ADMIN MENU ===" << endl;
-        cout << "Welcome, " << name << endl;
-        cout << "1. Manage Parties" << endl;
-        cout << "2. Add Candidate" << endl;
-        cout << "3. View All Candidates" << endl;
-        cout << "4. Register Voter" << endl;
-        cout << "5. View All Voters" << endl;
-        cout << "6. Set Election Timing" << endl;
-        cout << "7. View Election Status" << endl;
-        cout << "8. Generate Election Report" << endl;
-        cout << "9. Logout" << endl;
-        cout << "====================" << endl;
+    void displayMenu(ostream& out) override {
+        out << "\n=== ADMIN MENU ===" << endl;
+        out << "Welcome, " << name << endl;
+        out << "1. Manage Parties" << endl;
+        out << "2. Add Candidate" << endl;
+        out << "3. View All Candidates" << endl;
+        out << "4. Register Voter" << endl;
+        out << "5. View All Voters" << endl;
+        out << "6. Set Election Timing" << endl;
+        out << "7. View Election Status" << endl;
+        out << "8. Generate Election Report" << endl;
+        out << "9. Import Ballot File" << endl;
+        out << "10. Manage Constituencies" << endl;
+        out << "11. System Metrics" << endl;
+        out << "12. Logout" << endl;
+        out << "====================" << endl;
     }
 };
 
@@ -421,16 +1178,17 @@ public:
     }
     
     // File I/O methods for persistence
-    void saveToFile() const {
-        ofstream file("election_timing.txt");
+    void saveToFile(const string& filename = "election_timing.txt") const {
+        ofstream file(temporaryFile(filename));
         if (file.is_open()) {
             file << startTime << "," << endTime << "," << timingSet << endl;
             file.close();
+            commitFile(filename);
         }
     }
     
-    void loadFromFile() {
-        ifstream file("election_timing.txt");
+    void loadFromFile(const string& filename = "election_timing.txt") {
+        ifstream file(filename);
         if (file.is_open()) {
             string line;
             if (getline(file, line)) {
@@ -456,933 +1214,7721 @@ public:
 
 /*
  * ===================================================================
- * FILE HANDLER CLASS - TEMPLATE CLASS
- * DATA STRUCTURE CONCEPT: Template for generic file operations
+ * MAPPED FILE CLASS - read-only memory mapping of a whole file
+ * OOP CONCEPT: RAII - the mapping is released in the destructor
  * ===================================================================
  */
-template<typename T>
-class FileHandler {
+class MappedFile {
+private:
+    const char* bytes;
+    size_t length;
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#endif
+
 public:
-    // Static method - belongs to class, not instance
-    static void saveToFile(const vector<T>& data, const string& filename) {
-        ofstream file(filename);
-        if (file.is_open()) {
-            // Range-based for loop (C++11 feature)
-            for (const auto& item : data) {
-                file << item.toString() << endl;
-            }
-            file.close();
-        }
+    MappedFile() : bytes(nullptr), length(0) 
+#ifdef _WIN32
+        , fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#endif
+    {}
+    
+    // Mapping cannot be copied (it owns OS handles)
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    ~MappedFile() {
+        close();
     }
     
-    // Static method for loading data from file
-    static void loadFromFile(vector<T>& data, const string& filename) {
-        data.clear();
-        ifstream file(filename);
-        if (file.is_open()) {
-            string line;
-            while (getline(file, line)) {
-                if (!line.empty()) {
-                    T item;
-                    item.fromString(line);
-                    data.push_back(item);
-                }
-            }
-            file.close();
+    bool open(const string& filename) {
+        close();
+#ifdef _WIN32
+        fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0) {
+            close();
+            return false;
+        }
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr) {
+            close();
+            return false;
+        }
+        bytes = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        length = (size_t)size.QuadPart;
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // The mapping stays valid after the descriptor is closed
+        if (address == MAP_FAILED) return false;
+        bytes = (const char*)address;
+        length = (size_t)info.st_size;
+#endif
+        if (bytes == nullptr) {
+            close();
+            return false;
         }
+        return true;
     }
+    
+    void close() {
+#ifdef _WIN32
+        if (bytes != nullptr) UnmapViewOfFile(bytes);
+        if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (bytes != nullptr) munmap((void*)bytes, length);
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+    
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
 };
 
 /*
  * ===================================================================
- * MAIN VOTING SYSTEM CLASS
- * OOP CONCEPT: Composition - VotingSystem HAS-A DataManager, Admin, Timer
- * This is the main class that orchestrates the entire system
+ * SNAPSHOT READER CLASS - TEMPLATE CLASS
+ * Versioned binary snapshot: header, fixed-width records, string heap.
+ * The file is memory-mapped and records are read in place, so opening
+ * a snapshot costs no parsing; it only checks that every string
+ * reference lies inside the heap.
  * ===================================================================
  */
-class VotingSystem {
+struct SnapshotHeader {
+    char magic[4];          // "DVSB"
+    uint32_t version;
+    uint32_t stringFields;  // String columns per record
+    uint32_t intFields;     // Integer columns per record
+    uint64_t recordCount;
+    uint64_t heapSize;      // Bytes of string heap after the records
+};
+
+const uint32_t SNAPSHOT_VERSION = 1;
+
+template<typename T>
+class SnapshotReader {
 private:
-    // OOP CONCEPT: Composition relationships
-    DataManager<Candidate> candidates;  // HAS-A relationship
-    DataManager<Voter> voters;         // HAS-A relationship
-    DataManager<Party> parties;        // HAS-A relationship
-    Admin admin;                       // HAS-A relationship
-    ElectionTimer timer;               // HAS-A relationship
-    User* currentUser;                 // Pointer for polymorphism
-    int nextCandidateId;
-    int nextPartyId; 
-    int nextVoterId;
+    MappedFile file;
+    SnapshotHeader header;
+    size_t recordSize;
+    const char* records;
+    const char* heap;
 
-    string generateCandidateId() {
-        return to_string(nextCandidateId++);
-    }
-    
-    string generatePartyId() {
-        return to_string(nextPartyId++);
-    }
-    
-    string generateVoterId() {
-        return to_string(nextVoterId++);
-    }
+public:
+    SnapshotReader() : header(), recordSize(0), records(nullptr), heap(nullptr) {}
     
-    void initializeIdCounters() {
-        nextCandidateId = 101;
-        nextPartyId = 201;
-        nextVoterId = 10001;
+    // Map the snapshot and check that it matches the layout of T
+    bool open(const string& filename) {
+        if (!file.open(filename) || file.size() < sizeof(SnapshotHeader)) return false;
+        memcpy(&header, file.data(), sizeof(header));
         
-        // Find max existing candidate ID
-        for (const auto& candidate : candidates.getAllData()) {
-            int id = stoi(candidate.getId());
-            if (id >= nextCandidateId) {
-                nextCandidateId = id + 1;
-            }
+        if (memcmp(header.magic, "DVSB", 4) != 0 || header.version != SNAPSHOT_VERSION ||
+            header.stringFields != (uint32_t)T::SNAPSHOT_STRINGS || 
+            header.intFields != (uint32_t)T::SNAPSHOT_INTS) {
+            file.close();
+            return false;
         }
         
-        // Find max existing party ID
-        for (const auto& party : parties.getAllData()) {
-            int id = stoi(party.getId());
-            if (id >= nextPartyId) {
-                nextPartyId = id + 1;
-            }
+        // Truncated or corrupt file: the counts must add up to the file
+        // length (checked without overflow) and no string may leave the heap
+        recordSize = header.stringFields * sizeof(SnapshotStringRef) + header.intFields * sizeof(int64_t);
+        uint64_t available = file.size() - sizeof(SnapshotHeader);
+        if (header.recordCount > available / recordSize || 
+            header.heapSize != available - header.recordCount * recordSize) {
+            file.close();
+            return false;
         }
-        
-        // Find max existing voter ID
-        for (const auto& voter : voters.getAllData()) {
-            int id = stoi(voter.getId());
-            if (id >= nextVoterId) {
-                nextVoterId = id + 1;
+        records = file.data() + sizeof(SnapshotHeader);
+        heap = records + header.recordCount * recordSize;
+        if (!stringsInHeap()) {
+            file.close();
+            return false;
+        }
+        return true;
+    }
+    
+    size_t size() const { return (size_t)header.recordCount; }
+    
+    // In-place view of one record
+    SnapshotRecord record(size_t index) const {
+        return SnapshotRecord(records + index * recordSize, (int)header.stringFields, heap);
+    }
+
+private:
+    bool stringsInHeap() const {
+        for (uint64_t i = 0; i < header.recordCount; i++) {
+            const char* row = records + i * recordSize;
+            for (uint32_t f = 0; f < header.stringFields; f++) {
+                SnapshotStringRef ref;
+                memcpy(&ref, row + f * sizeof(SnapshotStringRef), sizeof(ref));
+                if ((uint64_t)ref.offset + ref.length > header.heapSize) return false;
             }
         }
+        return true;
     }
+};
 
-public:
-    // Constructor - initializes the system
-    VotingSystem() : admin("admin", "admin123", "System Administrator", "ADM001", "00000-0000000-0"), 
-                     currentUser(nullptr) {
-        loadData();
-        initializeIdCounters();
+/*
+ * ===================================================================
+ * TRACE EVENTS - timelines of startup, saves and reports
+ * With --trace <file>, every TraceSpan records when its scope started
+ * and how long it took, on which thread. The spans are written at exit
+ * as a Chrome trace (open it in ui.perfetto.dev or chrome://tracing).
+ * Without the flag a span costs one relaxed load and nothing else.
+ * ===================================================================
+ */
+
+// Append 'text' as the contents of a JSON string
+void appendJsonEscaped(string& escaped, string_view text) {
+    bool plain = true; // The usual case: nothing to escape
+    for (char c : text) plain = plain && (unsigned char)c >= 0x20 && c != '"' && c != '\\';
+    if (plain) {
+        escaped.append(text);
+        return;
     }
-    
-    // Destructor - saves data when system shuts down
-    ~VotingSystem() {
-        saveData();
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char code[8];
+                    snprintf(code, sizeof(code), "\\u%04x", (unsigned char)c);
+                    escaped += code;
+                } else {
+                    escaped += c;
+                }
+        }
     }
+}
+
+string jsonEscape(string_view text) {
+    string escaped;
+    escaped.reserve(text.size());
+    appendJsonEscaped(escaped, text);
+    return escaped;
+}
+
+class TraceLog {
+private:
+    struct Event {
+        const char* name;       // A string literal
+        string detail;          // File, table or constituency ("" if none)
+        int64_t startNanos;     // Since start()
+        int64_t durationNanos;
+        uint32_t thread;
+    };
     
-    // Save all data to files
-    void saveData() {
-        FileHandler<Candidate>::saveToFile(candidates.getAllData(), "candidates.txt");
-        FileHandler<Voter>::saveToFile(voters.getAllData(), "voters.txt");
-        FileHandler<Party>::saveToFile(parties.getAllData(), "parties.txt");
-        timer.saveToFile();
+    atomic<bool> enabled{false};
+    mutex eventsMutex;          // Spans end on many threads
+    vector<Event> events;
+    string filename;
+    chrono::steady_clock::time_point origin;
+
+public:
+    // Small per-thread numbers (the thread that starts tracing is 0)
+    static uint32_t threadNumber() {
+        static atomic<uint32_t> nextNumber{0};
+        thread_local uint32_t number = nextNumber.fetch_add(1, memory_order_relaxed);
+        return number;
     }
     
-    // Load all data from files
-    void loadData() {
-        FileHandler<Candidate>::loadFromFile(candidates.getAllData(), "candidates.txt");
-        FileHandler<Voter>::loadFromFile(voters.getAllData(), "voters.txt");
-        FileHandler<Party>::loadFromFile(parties.getAllData(), "parties.txt");
-        timer.loadFromFile();
+    bool isEnabled() const { return enabled.load(memory_order_relaxed); }
+    
+    void start(const string& traceFile) {
+        lock_guard<mutex> lock(eventsMutex);
+        threadNumber();
+        filename = traceFile;
+        origin = chrono::steady_clock::now();
+        enabled.store(true, memory_order_release);
     }
     
-    /*
-     * ===================================================================
-     * INPUT VALIDATION METHODS
-     * These ensure data integrity and user-friendly input
-     * ===================================================================
-     */
+    void add(const char* name, string detail, chrono::steady_clock::time_point begin, 
+             chrono::steady_clock::time_point end) {
+        Event event = {name, move(detail), chrono::duration_cast<chrono::nanoseconds>(begin - origin).count(),
+                       chrono::duration_cast<chrono::nanoseconds>(end - begin).count(), threadNumber()};
+        lock_guard<mutex> lock(eventsMutex);
+        events.push_back(move(event));
+    }
     
-    // Validate string input with length constraints
-    string getValidatedString(const string& prompt, int minLength = 1, int maxLength = 100) {
-        string input;
-        while (true) {
-            cout << prompt;
-            getline(cin, input);
-            
-            if (input.length() >= minLength && input.length() <= maxLength) {
-                return input;
-            }
-            cout << "Invalid input. Length should be between " << minLength 
-                 << " and " << maxLength << " characters." << endl;
+    // Complete ("X") events in microseconds, one per line
+    string formatJson() {
+        lock_guard<mutex> lock(eventsMutex);
+        ostringstream out;
+        out << fixed << setprecision(3);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+            << "\"args\":{\"name\":\"Digital Voting System\"}}";
+        for (const Event& event : events) {
+            out << ",\n{\"name\":\"" << jsonEscape(event.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+                << ",\"ts\":" << event.startNanos / 1e3 << ",\"dur\":" << event.durationNanos / 1e3;
+            if (!event.detail.empty()) out << ",\"args\":{\"detail\":\"" << jsonEscape(event.detail) << "\"}";
+            out << "}";
         }
+        out << "\n]}\n";
+        return out.str();
     }
     
-    // Validate integer input with range constraints
-    int getValidatedInt(const string& prompt, int min, int max) {
-        int input;
-        while (true) {
-            cout << prompt;
-            if (cin >> input && input >= min && input <= max) {
-                cin.ignore(); // Clear input buffer
-                return input;
-            }
-            cout << "Invalid input. Please enter a number between " << min 
-                 << " and " << max << "." << endl;
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    // Written when the program exits
+    ~TraceLog() {
+        if (!isEnabled()) return;
+        enabled.store(false);
+        if (writeFile(filename, formatJson())) {
+            cout << "Trace of " << events.size() << " spans written to " << filename << endl;
+        } else {
+            cout << "Warning: the trace could not be written to " << filename << endl;
         }
     }
+};
+
+TraceLog traceLog;
+
+// Records its scope as one span of the trace; 'detail' must outlive
+// the span (it is copied only when tracing)
+class TraceSpan {
+private:
+    const char* name;
+    string_view detail;
+    bool active;
+    chrono::steady_clock::time_point begin;
+
+public:
+    explicit TraceSpan(const char* spanName, string_view spanDetail = string_view()) 
+        : name(spanName), detail(spanDetail), active(traceLog.isEnabled()) {
+        if (active) begin = chrono::steady_clock::now();
+    }
     
-    // Validate CNIC format (Pakistani format: 00000-0000000-0)
-    string getValidatedCNIC(const string& prompt) {
-        string cnic;
-        while (true) {
-            cout << prompt << " (Format: 00000-0000000-0): ";
-            getline(cin, cnic);
-            
-            // Basic CNIC validation - 13 digits with 2 hyphens
-            if (cnic.length() == 15 && cnic[5] == '-' && cnic[13] == '-') {
-                // Check if all other characters are digits
-                bool valid = true;
-                for (int i = 0; i < 15; i++) {
-                    if (i != 5 && i != 13 && !isdigit(cnic[i])) {
-                        valid = false;
-                        break;
-                    }
-                }
-                if (valid) return cnic;
-            }
-            cout << "Invalid CNIC format. Please use format: 00000-0000000-0" << endl;
-        }
+    ~TraceSpan() {
+        if (active) traceLog.add(name, string(detail), begin, chrono::steady_clock::now());
     }
+    
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
 
-    string getHiddenPassword(const string& prompt) {
-    string password;
-    char ch;
+/*
+ * ===================================================================
+ * FILE HANDLER CLASS - TEMPLATE CLASS
+ * DATA STRUCTURE CONCEPT: Template for generic file operations
+ * ===================================================================
+ */
+template<typename T>
+class FileHandler {
+public:
+    // Static method - belongs to class, not instance. 'data' is a vector<T>
+    // or any container of views with the same toString() (e.g. VoterStore);
+    // records [first, last) are written (all by default). The file is
+    // replaced atomically (temporary file + sync + rename).
+    template<typename Container>
+    static bool saveToFile(const Container& data, const string& filename, 
+                           size_t first = 0, size_t last = SIZE_MAX) {
+        TraceSpan span("FileHandler::saveToFile", filename);
+        return writeFile(filename, formatText(data, first, last));
+    }
     
-    cout << prompt;
+    // The text file contents of records [first, last), one line each
+    template<typename Container>
+    static string formatText(const Container& data, size_t first = 0, size_t last = SIZE_MAX) {
+        TraceSpan span("FileHandler::formatText");
+        last = min(last, (size_t)data.size());
+        string text;
+        for (size_t i = first; i < last; i++) {
+            text += data[i].toString();
+            text += '\n';
+        }
+        return text;
+    }
     
-    // #ifdef _WIN32
-        while ((ch = _getch()) != '\r') {
-            if (ch == '\b') {
-                if (!password.empty()) {
-                    password.pop_back();
-                    cout << "\b \b";
-                }
-            } else {
-                    password += ch;
-                    cout << '*';
+    // Static method for loading data from file: the file is read in one
+    // go and the records are built from its structural index. Lines with
+    // a malformed numeric field are skipped.
+    static void loadFromFile(vector<T>& data, const string& filename) {
+        TraceSpan span("FileHandler::loadFromFile", filename);
+        data.clear();
+        string buffer;
+        if (!readWholeFile(filename, buffer)) return;
+        forEachRecord(buffer, 0, buffer.size(), [&](IndexedFields& fields) {
+            data.emplace_back(); // Construct the record in place
+            if (!data.back().fromFields(fields)) data.pop_back();
+        });
+    }
+    
+    // Parallel load: the file is read in one go, split into newline-aligned
+    // chunks and parsed by a pool of worker threads. A first pass counts the
+    // records of every chunk, so each chunk knows where its records start and
+    // parses them straight into place - file order is preserved and the
+    // result is identical to loadFromFile().
+    static void loadFromFileParallel(vector<T>& data, const string& filename, unsigned threadCount = 0) {
+        TraceSpan span("FileHandler::loadFromFileParallel", filename);
+        data.clear();
+        string buffer;
+        if (!readWholeFile(filename, buffer)) return;
+        
+        vector<size_t> bounds = splitAtNewlines(buffer, threadCount);
+        size_t chunkCount = bounds.size() - 1;
+        
+        // Pass 1: count records per chunk, then turn counts into start offsets
+        vector<size_t> firstRecord(chunkCount + 1, 0);
+        runParallel(chunkCount, threadCount, [&](size_t c) {
+            firstRecord[c + 1] = parseChunk(buffer, bounds[c], bounds[c + 1], nullptr);
+        });
+        for (size_t c = 0; c < chunkCount; c++) {
+            firstRecord[c + 1] += firstRecord[c];
+        }
+        
+        // Pass 2: parse every chunk into its own slice of the vector
+        data.resize(firstRecord[chunkCount]);
+        vector<size_t> parsed(chunkCount);
+        runParallel(chunkCount, threadCount, [&](size_t c) {
+            parsed[c] = parseChunk(buffer, bounds[c], bounds[c + 1], data.data() + firstRecord[c]);
+        });
+        
+        // Close the gaps that skipped lines left at the end of their slices
+        size_t kept = 0;
+        for (size_t c = 0; c < chunkCount; c++) {
+            if (kept != firstRecord[c]) {
+                move(data.begin() + firstRecord[c], data.begin() + firstRecord[c] + parsed[c], data.begin() + kept);
             }
+            kept += parsed[c];
         }
-    // #endif
-        cout << endl;
-        return password;
+        data.resize(kept);
     }
     
-    // Check if CNIC already exists in the system
-    bool cnicExists(const string& cnic) {
-        // Check in voters
-        for (const auto& voter : voters.getAllData()) {
-            if (voter.getCnic() == cnic) return true;
-        }
-        // Check in candidates
-        for (const auto& candidate : candidates.getAllData()) {
-            if (candidate.getCnic() == cnic) return true;
+    // Parse the lines in buffer[begin, end) into out[0..]; with out == nullptr
+    // the records are only counted (one record per non-empty line). Returns
+    // the number of records; lines with a malformed numeric field are
+    // skipped.
+    static size_t parseChunk(const string& buffer, size_t begin, size_t end, T* out) {
+        size_t records = 0;
+        if (out == nullptr) {
+            forEachLine(buffer, begin, end, [&](string_view) { records++; });
+        } else {
+            forEachRecord(buffer, begin, end, [&](IndexedFields& fields) {
+                if (out[records].fromFields(fields)) records++;
+            });
         }
-        return false;
+        return records;
+    }
+    
+    // Save data as a binary snapshot (see SnapshotReader for the layout);
+    // records [first, last), replaced atomically like saveToFile()
+    template<typename Container>
+    static bool saveToSnapshot(const Container& data, const string& filename, 
+                               size_t first = 0, size_t last = SIZE_MAX) {
+        TraceSpan span("FileHandler::saveToSnapshot", filename);
+        string contents;
+        return formatSnapshot(data, contents, first, last) && writeFile(filename, contents);
     }
     
-    // Validate date/time input
-    time_t getValidatedDateTime(const string& prompt) {
-        struct tm timeinfo = {};
-        int year, month, day, hour, minute;
+    // The snapshot file contents of records [first, last); false if the
+    // string heap would not fit the 32-bit string references (4 GiB)
+    template<typename Container>
+    static bool formatSnapshot(const Container& data, string& contents, size_t first = 0, size_t last = SIZE_MAX) {
+        TraceSpan span("FileHandler::formatSnapshot");
+        last = min(last, (size_t)data.size());
+        first = min(first, last);
+        const size_t recordSize = T::SNAPSHOT_STRINGS * sizeof(SnapshotStringRef) + 
+                                  T::SNAPSHOT_INTS * sizeof(int64_t);
+        vector<char> records((last - first) * recordSize);
+        string heap;
+        vector<string> strings;
+        vector<long long> ints;
         
-        while (true) {
-            cout << prompt << " (YYYY MM DD HH MM): ";
-            if (cin >> year >> month >> day >> hour >> minute) {
-                if (year >= 2024 && month >= 1 && month <= 12 && day >= 1 && day <= 31 &&
-                    hour >= 0 && hour <= 23 && minute >= 0 && minute <= 59) {
-                    
-                    timeinfo.tm_year = year - 1900;
-                    timeinfo.tm_mon = month - 1;
-                    timeinfo.tm_mday = day;
-                    timeinfo.tm_hour = hour;
-                    timeinfo.tm_min = minute;
-                    timeinfo.tm_sec = 0;
-                    
-                    cin.ignore();
-                    return mktime(&timeinfo);
-                }
+        for (size_t i = first; i < last; i++) {
+            data[i].toSnapshot(strings, ints);
+            char* row = records.data() + (i - first) * recordSize;
+            for (int f = 0; f < T::SNAPSHOT_STRINGS; f++) {
+                if (heap.size() + strings[f].size() > UINT32_MAX) return false;
+                SnapshotStringRef ref = {(uint32_t)heap.size(), (uint32_t)strings[f].size()};
+                memcpy(row + f * sizeof(ref), &ref, sizeof(ref));
+                heap += strings[f];
+            }
+            for (int f = 0; f < T::SNAPSHOT_INTS; f++) {
+                int64_t value = ints[f];
+                memcpy(row + T::SNAPSHOT_STRINGS * sizeof(SnapshotStringRef) + f * sizeof(value), 
+                       &value, sizeof(value));
             }
-            cout << "Invalid date/time format. Please use YYYY MM DD HH MM format." << endl;
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
         }
+        
+        SnapshotHeader header = {{'D', 'V', 'S', 'B'}, SNAPSHOT_VERSION, 
+                                 (uint32_t)T::SNAPSHOT_STRINGS, (uint32_t)T::SNAPSHOT_INTS,
+                                 (uint64_t)(last - first), (uint64_t)heap.size()};
+        contents.assign((const char*)&header, sizeof(header));
+        contents.append(records.data(), records.size());
+        contents += heap;
+        return true;
     }
     
-    /*
-     * ===================================================================
-     * PARTY MANAGEMENT METHODS
-     * These handle party-related operations
-     * ===================================================================
-     */
+    // Load data from a memory-mapped binary snapshot
+    static bool loadFromSnapshot(vector<T>& data, const string& filename) {
+        TraceSpan span("FileHandler::loadFromSnapshot", filename);
+        SnapshotReader<T> reader;
+        if (!reader.open(filename)) return false;
+        
+        data.clear();
+        data.resize(reader.size());
+        for (size_t i = 0; i < reader.size(); i++) {
+            data[i].fromSnapshot(reader.record(i));
+        }
+        return true;
+    }
     
-    void manageParties() {
-        while (true) {
-            cout << "\n=== PARTY MANAGEMENT ===" << endl;
-            cout << "1. Add New Party" << endl;
-            cout << "2. View All Parties" << endl;
-            cout << "3. View Party Details" << endl;
-            cout << "4. Back to Main Menu" << endl;
-            
-            int choice = getValidatedInt("Enter your choice: ", 1, 4);
-            
-            switch (choice) {
-                case 1: addParty(); break;
-                case 2: viewAllParties(); break;
-                case 3: viewPartyDetails(); break;
-                case 4: return;
+    // Load several files in order (the segments of a table), text or
+    // binary. False if one of them cannot be read.
+    static bool loadFromFiles(vector<T>& data, const vector<string>& filenames, bool binary) {
+        data.clear();
+        for (const string& filename : filenames) {
+            vector<T> segment;
+            if (binary) {
+                if (!loadFromSnapshot(segment, filename)) return false;
+            } else {
+                if (!filesystem::exists(filename)) return false;
+                loadFromFileParallel(segment, filename);
             }
+            data.insert(data.end(), make_move_iterator(segment.begin()), make_move_iterator(segment.end()));
         }
+        return true;
+    }
+};
+
+/*
+ * ===================================================================
+ * SEGMENTED TABLES - a saved table is split into fixed-size segments
+ * Segment k of "voters_NA-1" holds records [k * SEGMENT_RECORDS,
+ * (k + 1) * SEGMENT_RECORDS). Records never move, so a save rewrites
+ * only the segments holding changed records. A rewritten segment goes
+ * to a new file ("voters_NA-1.<k>.<generation>.txt" or ".bin") and the
+ * manifest, which names the current file of every segment of every
+ * table, is committed last: an interrupted save leaves the previous
+ * save intact, and the journal is replayed on top of it.
+ * ===================================================================
+ */
+const size_t SEGMENT_RECORDS = 8192;
+
+struct TableSegments {
+    string extension = ".txt";    // ".txt" or ".bin"
+    size_t recordCount = 0;
+    vector<uint64_t> generations; // Save that wrote each segment's file
+    
+    size_t segmentCount() const { return (recordCount + SEGMENT_RECORDS - 1) / SEGMENT_RECORDS; }
+    
+    bool operator==(const TableSegments& other) const {
+        return extension == other.extension && recordCount == other.recordCount && generations == other.generations;
     }
     
-    void addParty() {
-        cout << "\n=== ADD NEW PARTY ===" << endl;
-        
-        string id = generatePartyId();
-        
-        string name = getValidatedString("Party Name: ", 2, 50);
-        string symbol = getValidatedString("Party Symbol: ", 1, 20);
-        string manifesto = getValidatedString("Party Manifesto: ", 10, 500);
-        
-        parties.addData(Party(id, name, symbol, manifesto));
-        cout << "Party added successfully!" << endl;
+    // "<basePath>.<k>.<generation><extension>"
+    string segmentFile(const string& basePath, size_t k) const {
+        return basePath + "." + to_string(k) + "." + to_string(generations[k]) + extension;
     }
     
-    void viewAllParties() {
-        cout << "\n=== ALL PARTIES ===" << endl;
-        if (parties.getSize() == 0) {
-            cout << "No parties registered." << endl;
-            return;
-        }
-        
-        cout << left << setw(10) << "ID" << setw(30) << "Name" << setw(15) << "Symbol" 
-             << setw(12) << "Candidates" << setw(12) << "Total Votes" << endl;
-        cout << string(82, '-') << endl;
-        
-        for (const auto& party : parties.getAllData()) {
-            cout << left << setw(10) << party.getId()
-                 << setw(30) << party.getName()
-                 << setw(15) << party.getSymbol()
-                 << setw(12) << party.getCandidateIds().size()
-                 << setw(12) << party.getTotalVotes() << endl;
+    // The voter index of a segment file: "<basePath>.<k>.<generation>.idx"
+    static string indexFileOf(const string& segmentFile) {
+        return segmentFile.substr(0, segmentFile.rfind('.')) + ".idx";
+    }
+    
+    vector<string> segmentFiles(const string& basePath) const {
+        vector<string> files;
+        for (size_t k = 0; k < segmentCount(); k++) {
+            files.push_back(segmentFile(basePath, k));
         }
+        return files;
     }
+};
+
+// "tables.manifest": the generation of the last save, then one line
+// per table: "name,extension,recordCount,generation generation ..."
+struct DataManifest {
+    uint64_t generation = 0;
+    map<string, TableSegments> tables;
     
-    void viewPartyDetails() {
-        if (parties.getSize() == 0) {
-            cout << "No parties available." << endl;
-            return;
+    const TableSegments* find(const string& table) const {
+        auto it = tables.find(table);
+        return it == tables.end() ? nullptr : &it->second;
+    }
+    
+    bool loadFromFile(const string& filename) {
+        ifstream file(filename);
+        string line;
+        if (!getline(file, line) || !parseNumber(line, generation)) return false;
+        tables.clear();
+        while (getline(file, line)) {
+            FieldTokenizer fields(line);
+            string name(fields.next());
+            TableSegments& table = tables[name];
+            table.extension = string(fields.next());
+            if (!parseNumber(fields.next(), table.recordCount)) return false;
+            string_view list = fields.next();
+            FieldTokenizer generations(list, ' ');
+            while (!list.empty() && generations.hasMore()) {
+                uint64_t segmentGeneration = 0;
+                if (!parseNumber(generations.next(), segmentGeneration)) return false;
+                table.generations.push_back(segmentGeneration);
+            }
+            if (table.generations.size() != table.segmentCount()) return false;
         }
-        
-        viewAllParties();
-        string partyId = getValidatedString("Enter Party ID to view details: ");
-        
-        for (const auto& party : parties.getAllData()) {
-            if (party.getId() == partyId) {
-                cout << "\n=== PARTY DETAILS ===" << endl;
-                cout << "Party ID: " << party.getId() << endl;
-                cout << "Party Name: " << party.getName() << endl;
-                cout << "Symbol: " << party.getSymbol() << endl;
-                cout << "Manifesto: " << party.getManifesto() << endl;
-                cout << "Total Votes: " << party.getTotalVotes() << endl;
-                cout << "Number of Candidates: " << party.getCandidateIds().size() << endl;
-                
-                // Show party candidates
-                if (!party.getCandidateIds().empty()) {
-                    cout << "\nParty Candidates:" << endl;
-                    for (const string& candidateId : party.getCandidateIds()) {
-                        for (const auto& candidate : candidates.getAllData()) {
-                            if (candidate.getId() == candidateId) {
-                                cout << "- " << candidate.getName() 
-                                     << " (ID: " << candidate.getId() 
-                                     << ", Votes: " << candidate.getVotes() << ")" << endl;
-                                break;
-                            }
-                        }
-                    }
-                }
-                return;
+        return true;
+    }
+    
+    bool saveToFile(const string& filename) const {
+        ofstream file(temporaryFile(filename));
+        if (!file.is_open()) return false;
+        file << generation << '\n';
+        for (const auto& entry : tables) {
+            const TableSegments& table = entry.second;
+            file << entry.first << "," << table.extension << "," << table.recordCount << ",";
+            for (size_t k = 0; k < table.generations.size(); k++) {
+                file << (k > 0 ? " " : "") << table.generations[k];
             }
+            file << '\n';
         }
-        cout << "Party not found!" << endl;
+        file.close();
+        return !file.fail() && commitFile(filename);
+    }
+};
+
+/*
+ * ===================================================================
+ * CNIC KERNELS - validate "00000-0000000-0" and pack its 13 digits
+ * into one integer (3520212345671) in a single pass
+ * The SSE2 kernel checks all 15 bytes at once: subtracting '0' (or '-'
+ * at the hyphens) must leave at most 9 (or 0) in every byte, and a
+ * multiply-add of the same bytes by their place values yields the
+ * number. The AVX2 kernel handles two CNICs per instruction for bulk
+ * imports. The bulk kernel is chosen at startup from the CPU; the
+ * scalar loop is the fallback on other processors.
+ * ===================================================================
+ */
+const uint64_t INVALID_CNIC = UINT64_MAX; // Result for a malformed CNIC
+
+uint64_t parseCnicScalar(string_view text) {
+    if (text.size() != 15 || text[5] != '-' || text[13] != '-') return INVALID_CNIC;
+    uint64_t value = 0;
+    for (int i = 0; i < 15; i++) {
+        if (i == 5 || i == 13) continue;
+        unsigned digit = (unsigned char)text[i] - '0';
+        if (digit > 9) return INVALID_CNIC;
+        value = value * 10 + digit;
     }
+    return value;
+}
+
+#ifdef X86_SIMD
+// Vector byte i holds CNIC byte i for i < 8 and byte i - 1 for i >= 8:
+// two overlapping 8-byte loads never read past the 15 bytes. Vector
+// byte 8 repeats CNIC byte 7 and is ignored.
+inline __m128i loadCnic(const char* text) {
+    return _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)text), _mm_loadl_epi64((const __m128i*)(text + 7)));
+}
+
+// The number from the place-value sums: lanes 0-2 of 'low' are the
+// first five digits, lane 3 the next two; lanes 0-2 of 'high' are the
+// five after those and lane 3 the check digit
+inline uint64_t combineCnic(const uint32_t* low, const uint32_t* high) {
+    return (uint64_t)(low[0] + low[1] + low[2]) * 100000000 + (uint64_t)low[3] * 1000000 + 
+           (uint64_t)(high[0] + high[1] + high[2]) * 10 + high[3];
+}
+
+uint64_t parseCnicSse2(string_view text) {
+    if (text.size() != 15) return INVALID_CNIC;
+    const __m128i base = _mm_setr_epi8('0', '0', '0', '0', '0', '-', '0', '0', 0, '0', '0', '0', '0', '0', '-', '0');
+    const __m128i limit = _mm_setr_epi8(9, 9, 9, 9, 9, 0, 9, 9, (char)255, 9, 9, 9, 9, 9, 0, 9);
+    __m128i digits = _mm_sub_epi8(loadCnic(text.data()), base);
+    // Valid when no byte exceeds its limit (unsigned compare)
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(digits, limit), limit)) != 0xFFFF) return INVALID_CNIC;
     
-    /*
-     * ===================================================================
-     * USER AUTHENTICATION METHODS
-     * OOP CONCEPT: Polymorphism - different types of users
-     * ===================================================================
-     */
+    const __m128i zero = _mm_setzero_si128();
+    alignas(16) uint32_t low[4], high[4];
+    _mm_store_si128((__m128i*)low, _mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), 
+                                                  _mm_setr_epi16(10000, 1000, 100, 10, 1, 0, 10, 1)));
+    _mm_store_si128((__m128i*)high, _mm_madd_epi16(_mm_unpackhi_epi8(digits, zero), 
+                                                   _mm_setr_epi16(0, 10000, 1000, 100, 10, 1, 0, 1)));
+    return combineCnic(low, high);
+}
+
+// AVX2 also shuffles within each half, so the 13 digits are moved
+// next to each other and the whole number is formed in the vector:
+// digit pairs, then groups of four and of eight, then one 64-bit sum
+TARGET_AVX2 void packCnicsAvx2(const string_view* cnics, size_t count, uint64_t* packed) {
+    const __m256i base = _mm256_setr_epi8('0', '0', '0', '0', '0', '-', '0', '0', 0, '0', '0', '0', '0', '0', '-', '0',
+                                          '0', '0', '0', '0', '0', '-', '0', '0', 0, '0', '0', '0', '0', '0', '-', '0');
+    const __m256i limit = _mm256_setr_epi8(9, 9, 9, 9, 9, 0, 9, 9, (char)255, 9, 9, 9, 9, 9, 0, 9,
+                                           9, 9, 9, 9, 9, 0, 9, 9, (char)255, 9, 9, 9, 9, 9, 0, 9);
+    // Digits to bytes 3-15 of each half, behind three zeros (index -128)
+    const __m256i compact = _mm256_setr_epi8(-128, -128, -128, 0, 1, 2, 3, 4, 6, 7, 9, 10, 11, 12, 13, 15,
+                                             -128, -128, -128, 0, 1, 2, 3, 4, 6, 7, 9, 10, 11, 12, 13, 15);
+    const __m256i tensAndOnes = _mm256_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1,
+                                                 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1);
+    const __m256i hundreds = _mm256_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1);
+    const __m256i tenThousands = _mm256_setr_epi16(10000, 1, 10000, 1, 0, 0, 0, 0, 10000, 1, 10000, 1, 0, 0, 0, 0);
+    const __m256i hundredMillion = _mm256_set1_epi64x(100000000);
     
-    // OOP CONCEPT: Polymorphism - returns pointer to base class User
-    User* login() {
-        string username, password;
-        cout << "\n=== LOGIN ===" << endl;
-        username = getValidatedString("Username: ");
-        password = getHiddenPassword("Password: ");
-        
-        // Check admin login first
-        if (admin.authenticate(username, password)) {
-            cout << "Admin login successful!" << endl;
-            return &admin;
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        if (cnics[i].size() != 15 || cnics[i + 1].size() != 15) {
+            packed[i] = parseCnicSse2(cnics[i]);
+            packed[i + 1] = parseCnicSse2(cnics[i + 1]);
+            continue;
         }
-        
-        // Check voter login
-        for (auto& voter : voters.getAllData()) {
-            if (voter.authenticate(username, password)) {
-                cout << "Voter login successful!" << endl;
-                return &voter; // Polymorphism - returning Voter* as User*
-            }
+        // One CNIC in each 128-bit half
+        __m256i digits = _mm256_sub_epi8(_mm256_set_m128i(loadCnic(cnics[i + 1].data()), loadCnic(cnics[i].data())), 
+                                         base);
+        uint32_t valid = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(digits, limit), limit));
+        __m256i pairs = _mm256_maddubs_epi16(_mm256_shuffle_epi8(digits, compact), tensAndOnes);
+        __m256i fours = _mm256_madd_epi16(pairs, hundreds);
+        __m256i eights = _mm256_madd_epi16(_mm256_packus_epi32(fours, fours), tenThousands);
+        // 64-bit lanes 0 and 2: first eight digits * 10^8 + last eight
+        __m256i numbers = _mm256_add_epi64(_mm256_mul_epu32(eights, hundredMillion), _mm256_srli_epi64(eights, 32));
+        packed[i] = (valid & 0xFFFF) == 0xFFFF ? (uint64_t)_mm256_extract_epi64(numbers, 0) : INVALID_CNIC;
+        packed[i + 1] = (valid >> 16) == 0xFFFF ? (uint64_t)_mm256_extract_epi64(numbers, 2) : INVALID_CNIC;
+    }
+    for (; i < count; i++) packed[i] = parseCnicSse2(cnics[i]);
+}
+#endif
+
+// Validate and pack one CNIC (INVALID_CNIC if malformed)
+inline uint64_t parseCnic(string_view text) {
+#ifdef X86_SIMD
+    return parseCnicSse2(text); // SSE2 is part of every x86-64 processor
+#else
+    return parseCnicScalar(text);
+#endif
+}
+
+// Validate and pack 'count' CNICs into 'packed' (INVALID_CNIC for each
+// malformed one) - the bulk path for electoral-roll extracts
+void packCnics(const string_view* cnics, size_t count, uint64_t* packed, SimdKernel kernel = bestSimdKernel) {
+#ifdef X86_SIMD
+    if (kernel == SimdKernel::AVX2) {
+        packCnicsAvx2(cnics, count, packed);
+        return;
+    }
+    if (kernel == SimdKernel::SSE2) {
+        for (size_t i = 0; i < count; i++) packed[i] = parseCnicSse2(cnics[i]);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; i++) packed[i] = parseCnicScalar(cnics[i]);
+}
+
+/*
+ * ===================================================================
+ * STRING ARENA - many small strings packed into one buffer
+ * A record keeps an 8-byte (offset, length) reference instead of a
+ * std::string (32 bytes plus a heap block for longer values).
+ * ===================================================================
+ */
+struct ArenaRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+class StringArena {
+private:
+    vector<char> bytes;
+
+public:
+    ArenaRef add(string_view text) {
+        if (bytes.size() + text.size() > UINT32_MAX) {
+            throw length_error("String arena is full");
         }
-        
-        cout << "Invalid credentials!" << endl;
-        return nullptr;
+        ArenaRef ref = {(uint32_t)bytes.size(), (uint32_t)text.size()};
+        bytes.insert(bytes.end(), text.begin(), text.end());
+        return ref;
     }
     
-    /*
-     * ===================================================================
-     * CANDIDATE MANAGEMENT METHODS
-     * ===================================================================
-     */
+    string_view get(ArenaRef ref) const {
+        return string_view(bytes.data() + ref.offset, ref.length);
+    }
+    
+    // Append another arena; its references must be shifted by the returned offset
+    uint32_t append(const StringArena& other) {
+        if (bytes.size() + other.bytes.size() > UINT32_MAX) {
+            throw length_error("String arena is full");
+        }
+        uint32_t base = (uint32_t)bytes.size();
+        bytes.insert(bytes.end(), other.bytes.begin(), other.bytes.end());
+        return base;
+    }
+    
+    void clear() { bytes.clear(); }
+    void shrinkToFit() { bytes.shrink_to_fit(); }
+    size_t memoryUsage() const { return bytes.capacity(); }
+};
+
+/*
+ * ===================================================================
+ * POSITION INDEX - TEMPLATE CLASS
+ * DATA STRUCTURE CONCEPT: Open-addressing hash table (linear probing)
+ * Maps a key to a record position but stores only the 4-byte positions;
+ * keys are read back from the record columns through 'keyOf'. At most
+ * 70% of the slots are used, so an index costs 6-12 bytes per record
+ * instead of a node per key in an unordered_map.
+ * ===================================================================
+ */
+template<typename Key, typename Hash = hash<Key>>
+class PositionIndex {
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+    vector<uint32_t> slots; // Power-of-two table of positions
+    size_t used = 0;
+    
+    size_t firstSlot(const Key& key) const {
+        uint64_t h = (uint64_t)Hash()(key); // Mix, so sequential keys spread out
+        h ^= h >> 31;
+        h *= 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 29;
+        return (size_t)h & (slots.size() - 1);
+    }
+    
+    template<typename KeyOf>
+    void rehash(size_t slotCount, KeyOf keyOf) {
+        vector<uint32_t> old;
+        old.swap(slots);
+        slots.assign(slotCount, EMPTY);
+        for (uint32_t position : old) {
+            if (position == EMPTY) continue;
+            size_t i = firstSlot(keyOf(position));
+            while (slots[i] != EMPTY) i = (i + 1) & (slots.size() - 1);
+            slots[i] = position;
+        }
+    }
+    
+    static size_t slotsFor(size_t count) {
+        size_t slotCount = 16;
+        while (slotCount * 7 < count * 10) slotCount *= 2;
+        return slotCount;
+    }
+
+public:
+    static constexpr uint32_t npos = EMPTY;
+    
+    // Position stored under 'key', or npos
+    template<typename KeyOf>
+    uint32_t find(const Key& key, KeyOf keyOf) const {
+        if (slots.empty()) return npos;
+        for (size_t i = firstSlot(key); slots[i] != EMPTY; i = (i + 1) & (slots.size() - 1)) {
+            if (keyOf(slots[i]) == key) return slots[i];
+        }
+        return npos;
+    }
+    
+    // Index 'position' under keyOf(position); refused if the key is
+    // already present (the first record with a key wins)
+    template<typename KeyOf>
+    bool insert(uint32_t position, KeyOf keyOf) {
+        if (slotsFor(used + 1) > slots.size()) rehash(slotsFor(used + 1), keyOf);
+        Key key = keyOf(position);
+        size_t i = firstSlot(key);
+        for (; slots[i] != EMPTY; i = (i + 1) & (slots.size() - 1)) {
+            if (keyOf(slots[i]) == key) return false;
+        }
+        slots[i] = position;
+        used++;
+        return true;
+    }
+    
+    // Make room for 'count' records without growing step by step
+    template<typename KeyOf>
+    void reserve(size_t count, KeyOf keyOf) {
+        if (slotsFor(count) > slots.size()) rehash(slotsFor(count), keyOf);
+    }
+    
+    void clear() {
+        slots.clear();
+        used = 0;
+    }
+    
+    size_t memoryUsage() const { return slots.capacity() * sizeof(uint32_t); }
+};
+
+/*
+ * ===================================================================
+ * VOTER STORE - columnar (structure-of-arrays) storage for voters
+ * DATA STRUCTURE CONCEPT: Structure of arrays - one column per field:
+ *   - the ID as uint32_t and the 13-digit CNIC packed into a uint64_t
+ *   - username, password and name as references into a StringArena
+ *   - the has-voted flags as a bitset, claimed with an atomic fetch_or
+ *   - the chosen candidate as a position in the constituency's
+ *     candidate vector instead of a copy of its ID
+ * There is no vtable pointer and no std::string per voter. VoterView
+ * gives one row the familiar Voter accessors; Voter itself remains the
+ * record type for registration, files and logged-in sessions.
+ * ===================================================================
+ */
+class VoterStore;
+
+class VoterView {
+private:
+    const VoterStore* store;
+    uint32_t position;
+
+public:
+    VoterView(const VoterStore* s, uint32_t p) : store(s), position(p) {}
+    
+    // Same accessors as Voter
+    string getUsername() const;
+    string getName() const;
+    string getId() const;
+    string getCnic() const;
+    bool getHasVoted() const;
+    string getVotedFor() const;
+    bool authenticate(const string& un, const string& pw) const;
+    string toString() const;
+    
+    static const int SNAPSHOT_STRINGS = 6;
+    static const int SNAPSHOT_INTS = 1;
+    void toSnapshot(vector<string>& strings, vector<long long>& ints) const;
+    
+    uint32_t getPosition() const { return position; }
+    uint32_t getNumericId() const;
+    Voter toVoter() const; // Standalone copy (e.g. for a logged-in session)
+};
+
+class VoterStore {
+private:
+    // CNICs that are not 13 digits are kept verbatim in the arena:
+    // flag bit, length in bits 32-62, arena offset in bits 0-31
+    static constexpr uint64_t IRREGULAR_CNIC = 1ULL << 63;
+    
+    // IDs that are not canonical numbers below 2^31 ("V-17", "010002")
+    // are kept verbatim as well: flag bit, then an index into irregularIds
+    static constexpr uint32_t IRREGULAR_ID = 1u << 31;
+    
+    vector<uint32_t> ids;
+    vector<ArenaRef> irregularIds;
+    vector<uint64_t> cnics;
+    vector<ArenaRef> usernames;
+    vector<ArenaRef> passwords;
+    vector<ArenaRef> names;
+    vector<CopyableAtomic<int32_t>> votedCandidate; // Position in 'candidates', -1 = none
+    vector<CopyableAtomic<uint64_t>> votedBits;     // Bit p = voter p has voted
+    vector<CopyableAtomic<uint64_t>> dirtyBits;     // Bit p = voter p changed since the last save
+    StringArena arena;
+    
+    PositionIndex<uint32_t> idIndex;
+    PositionIndex<uint64_t> cnicIndex;     // Regular (packed) CNICs only
+    PositionIndex<string_view> usernameIndex;
+    
+    DataManager<Candidate>* candidates;     // The constituency's candidates
+    
+    // Key extractors for the indexes
+    auto idOf() const { return [this](uint32_t p) { return ids[p]; }; }
+    auto cnicOf() const { return [this](uint32_t p) { return cnics[p]; }; }
+    auto usernameOf() const { return [this](uint32_t p) { return arena.get(usernames[p]); }; }
+    
+    void indexPosition(uint32_t p) {
+        if (!(ids[p] & IRREGULAR_ID)) idIndex.insert(p, idOf());
+        if (!(cnics[p] & IRREGULAR_CNIC)) cnicIndex.insert(p, cnicOf());
+        usernameIndex.insert(p, usernameOf());
+    }
+
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+    
+    explicit VoterStore(DataManager<Candidate>* candidateList = nullptr) : candidates(candidateList) {}
+    
+    // "35202-1234567-1" (dashes optional) -> 3520212345671; false if not 13 digits
+    static bool packCnic(string_view text, uint64_t& packed) {
+        if (text.size() == 15) {
+            uint64_t number = parseCnic(text); // The usual form, in one pass
+            if (number != INVALID_CNIC) {
+                packed = number;
+                return true;
+            }
+        }
+        char digits[13];
+        size_t count = 0;
+        for (char c : text) {
+            if (c == '-') continue;
+            if (c < '0' || c > '9' || count == 13) return false;
+            digits[count++] = c;
+        }
+        return count == 13 && parseNumber(string_view(digits, 13), packed);
+    }
+    
+    // Canonical voter ID (decimal, no leading zero, below 2^31) -> its
+    // number; false for any other text
+    static bool packId(string_view text, uint32_t& packed) {
+        uint32_t number = 0;
+        if (!parseNumber(text, number) || number >= IRREGULAR_ID || (text.size() > 1 && text[0] == '0')) {
+            return false;
+        }
+        packed = number;
+        return true;
+    }
+    
+    static string formatCnic(uint64_t packed) {
+        char digits[14];
+        snprintf(digits, sizeof(digits), "%013llu", (unsigned long long)packed);
+        string text(digits);
+        return text.substr(0, 5) + "-" + text.substr(5, 7) + "-" + text.substr(12, 1);
+    }
+    
+    // Append one voter without indexing it (used while loading)
+    void appendFields(string_view username, string_view password, string_view name, string_view id,
+                      string_view cnic, bool hasVoted, string_view votedFor) {
+        uint32_t p = (uint32_t)ids.size();
+        uint32_t packedId = 0;
+        if (packId(id, packedId)) {
+            ids.push_back(packedId);
+        } else {
+            ids.push_back(IRREGULAR_ID | (uint32_t)irregularIds.size());
+            irregularIds.push_back(arena.add(id));
+        }
+        uint64_t number = 0;
+        if (packCnic(cnic, number)) {
+            cnics.push_back(number);
+        } else {
+            ArenaRef ref = arena.add(cnic);
+            cnics.push_back(IRREGULAR_CNIC | ((uint64_t)ref.length << 32) | ref.offset);
+        }
+        usernames.push_back(arena.add(username));
+        passwords.push_back(arena.add(password));
+        names.push_back(arena.add(name));
+        
+        // A vote for a candidate that is not in this constituency keeps
+        // the has-voted flag but no candidate reference
+        int32_t candidate = -1;
+        if (hasVoted && !votedFor.empty() && candidates != nullptr) {
+            const Candidate* found = candidates->findItem("id", string(votedFor));
+            if (found != nullptr) candidate = (int32_t)(found - candidates->getAllData().data());
+        }
+        votedCandidate.push_back(CopyableAtomic<int32_t>(candidate));
+        if (p % 64 == 0) {
+            votedBits.push_back(CopyableAtomic<uint64_t>(0));
+            dirtyBits.push_back(CopyableAtomic<uint64_t>(0));
+        }
+        if (hasVoted) votedBits[p / 64].fetch_or(1ULL << (p % 64), memory_order_relaxed);
+        markDirty(p); // New records are unsaved until a loader marks them clean
+    }
+    
+    // One line of the voters.txt format
+    void appendRecord(string_view line) {
+        FieldTokenizer fields(line);
+        appendRecord(fields);
+    }
+    
+    template<typename Fields>
+    void appendRecord(Fields& fields) {
+        string_view username = fields.next(), password = fields.next(), name = fields.next();
+        string_view id = fields.next(), cnic = fields.next();
+        bool hasVoted = fields.next() == "1";
+        appendFields(username, password, name, id, cnic, hasVoted, fields.next());
+    }
+    
+    // Add a voter and index it (same role as DataManager::addData)
+    void addData(const Voter& voter) {
+        appendRecord(voter.toString());
+        indexPosition((uint32_t)ids.size() - 1);
+    }
+    
+    // Add and index a voter read in place from a saved file
+    void addFields(string_view username, string_view password, string_view name, string_view id,
+                   string_view cnic, bool hasVoted, string_view votedFor) {
+        appendFields(username, password, name, id, cnic, hasVoted, votedFor);
+        indexPosition((uint32_t)ids.size() - 1);
+    }
+    
+    // Move the rows of 'part' to the end of this store (loading merges
+    // the chunks parsed by different threads this way)
+    void append(VoterStore& part) {
+        uint32_t base = arena.append(part.arena);
+        auto shift = [base](ArenaRef ref) { return ArenaRef{ref.offset + base, ref.length}; };
+        uint32_t irregularBase = (uint32_t)irregularIds.size();
+        for (ArenaRef ref : part.irregularIds) irregularIds.push_back(shift(ref));
+        for (size_t i = 0; i < part.ids.size(); i++) {
+            uint32_t p = (uint32_t)ids.size();
+            uint32_t id = part.ids[i];
+            ids.push_back(id & IRREGULAR_ID ? id + irregularBase : id); // Index sits in the low bits
+            uint64_t cnic = part.cnics[i];
+            cnics.push_back(cnic & IRREGULAR_CNIC ? cnic + base : cnic); // Offset sits in the low bits
+            usernames.push_back(shift(part.usernames[i]));
+            passwords.push_back(shift(part.passwords[i]));
+            names.push_back(shift(part.names[i]));
+            votedCandidate.push_back(part.votedCandidate[i]);
+            if (p % 64 == 0) {
+                votedBits.push_back(CopyableAtomic<uint64_t>(0));
+                dirtyBits.push_back(CopyableAtomic<uint64_t>(0));
+            }
+            if (part.getHasVoted((uint32_t)i)) votedBits[p / 64].fetch_or(1ULL << (p % 64), memory_order_relaxed);
+            if (part.isRangeDirty(i, i + 1)) markDirty(p);
+        }
+        part.clearData();
+    }
+    
+    void rebuildIndexes() {
+        idIndex.clear();
+        cnicIndex.clear();
+        usernameIndex.clear();
+        idIndex.reserve(ids.size(), idOf());
+        cnicIndex.reserve(ids.size(), cnicOf());
+        usernameIndex.reserve(ids.size(), usernameOf());
+        for (uint32_t p = 0; p < ids.size(); p++) {
+            indexPosition(p);
+        }
+    }
+    
+    void clearData() {
+        *this = VoterStore(candidates);
+    }
+    
+    // Release the spare capacity left by vector growth (after loading)
+    void shrinkToFit() {
+        ids.shrink_to_fit();
+        irregularIds.shrink_to_fit();
+        cnics.shrink_to_fit();
+        usernames.shrink_to_fit();
+        passwords.shrink_to_fit();
+        names.shrink_to_fit();
+        votedCandidate.shrink_to_fit();
+        votedBits.shrink_to_fit();
+        dirtyBits.shrink_to_fit();
+        arena.shrinkToFit();
+    }
+    
+    // Parallel text load of one file or of the segments of a table: every
+    // chunk of every file is parsed into its own store, then the chunks
+    // are appended in order. False if a file cannot be read.
+    bool loadFromFiles(const vector<string>& filenames, unsigned threadCount = 0) {
+        TraceSpan span("VoterStore::loadFromFiles", filenames.empty() ? string_view() : filenames.front());
+        clearData();
+        struct Chunk { size_t file, begin, end; };
+        vector<string> buffers(filenames.size());
+        vector<Chunk> chunks;
+        for (size_t f = 0; f < filenames.size(); f++) {
+            if (!readWholeFile(filenames[f], buffers[f])) return false;
+            vector<size_t> bounds = splitAtNewlines(buffers[f], threadCount);
+            for (size_t c = 0; c + 1 < bounds.size(); c++) {
+                chunks.push_back(Chunk{f, bounds[c], bounds[c + 1]});
+            }
+        }
+        
+        vector<VoterStore> parts(chunks.size(), VoterStore(candidates));
+        runParallel(parts.size(), threadCount, [&](size_t c) {
+            forEachRecord(buffers[chunks[c].file], chunks[c].begin, chunks[c].end, 
+                          [&](IndexedFields& fields) { parts[c].appendRecord(fields); });
+        });
+        for (auto& part : parts) {
+            append(part);
+        }
+        shrinkToFit();
+        rebuildIndexes();
+        markAllClean();
+        return true;
+    }
+    
+    bool loadFromFile(const string& filename, unsigned threadCount = 0) {
+        return loadFromFiles({filename}, threadCount);
+    }
+    
+    bool loadFromSnapshots(const vector<string>& filenames) {
+        TraceSpan span("VoterStore::loadFromSnapshots", filenames.empty() ? string_view() : filenames.front());
+        clearData();
+        for (const string& filename : filenames) {
+            SnapshotReader<VoterView> reader;
+            if (!reader.open(filename)) return false;
+            for (size_t i = 0; i < reader.size(); i++) {
+                SnapshotRecord record = reader.record(i);
+                appendFields(record.getString(0), record.getString(1), record.getString(2), record.getString(3),
+                             record.getString(4), record.getInt(0) != 0, record.getString(5));
+            }
+        }
+        shrinkToFit();
+        rebuildIndexes();
+        markAllClean();
+        return true;
+    }
+    
+    bool loadFromSnapshot(const string& filename) {
+        return loadFromSnapshots({filename});
+    }
+    
+    // Lookup by a declared key ("id", "cnic" or "username"); npos if absent
+    uint32_t find(const string& indexName, const string& key) const {
+        uint64_t number = 0;
+        if (indexName == "id") {
+            uint32_t id = 0;
+            if (packId(key, id)) return idIndex.find(id, idOf());
+            for (uint32_t p = 0; p < ids.size(); p++) { // Irregular IDs are not indexed
+                if ((ids[p] & IRREGULAR_ID) && arena.get(irregularIds[ids[p] & ~IRREGULAR_ID]) == key) return p;
+            }
+            return npos;
+        }
+        if (indexName == "cnic") {
+            if (packCnic(key, number)) return cnicIndex.find(number, cnicOf());
+            for (uint32_t p = 0; p < cnics.size(); p++) { // Irregular CNICs are not indexed
+                if ((cnics[p] & IRREGULAR_CNIC) && getCnic(p) == key) return p;
+            }
+            return npos;
+        }
+        if (indexName == "username") {
+            return usernameIndex.find(string_view(key), usernameOf());
+        }
+        throw invalid_argument("Unknown index: " + indexName);
+    }
+    
+    bool containsKey(const string& indexName, const string& key) const {
+        return find(indexName, key) != npos;
+    }
+    
+    // Claim the voter's has-voted bit; false if it was already set. Only
+    // the thread that sets the bit records the candidate.
+    bool claimVote(uint32_t p, int32_t candidatePosition) {
+        uint64_t bit = 1ULL << (p % 64);
+        if (votedBits[p / 64].fetch_or(bit, memory_order_acq_rel) & bit) {
+            return false;
+        }
+        votedCandidate[p].store(candidatePosition, memory_order_release);
+        markDirty(p);
+        return true;
+    }
+    
+    // Dirty tracking: voters changed since the last save
+    void markDirty(uint32_t p) {
+        dirtyBits[p / 64].fetch_or(1ULL << (p % 64), memory_order_relaxed);
+    }
+    
+    bool isRangeDirty(size_t first, size_t last) const {
+        for (size_t p = first; p < last; p++) {
+            if (p % 64 == 0 && p + 64 <= last) {
+                if (dirtyBits[p / 64].load(memory_order_relaxed) != 0) return true;
+                p += 63; // Whole word checked
+            } else if ((dirtyBits[p / 64].load(memory_order_relaxed) >> (p % 64)) & 1) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void markAllClean() {
+        for (auto& word : dirtyBits) word.store(0, memory_order_relaxed);
+    }
+    
+    // Column accessors by position
+    int getSize() const { return (int)ids.size(); }
+    size_t size() const { return ids.size(); }
+    uint32_t getNumericId(uint32_t p) const { return ids[p]; } // Flagged index for an irregular ID
+    
+    // The ID as it was registered or loaded
+    string getId(uint32_t p) const {
+        uint32_t id = ids[p];
+        return id & IRREGULAR_ID ? string(arena.get(irregularIds[id & ~IRREGULAR_ID])) : to_string(id);
+    }
+    string_view getUsernameView(uint32_t p) const { return arena.get(usernames[p]); }
+    string_view getPasswordView(uint32_t p) const { return arena.get(passwords[p]); }
+    string_view getNameView(uint32_t p) const { return arena.get(names[p]); }
+    
+    string getCnic(uint32_t p) const {
+        uint64_t cnic = cnics[p];
+        if (!(cnic & IRREGULAR_CNIC)) return formatCnic(cnic);
+        return string(arena.get(ArenaRef{(uint32_t)cnic, (uint32_t)((cnic & ~IRREGULAR_CNIC) >> 32)}));
+    }
+    
+    // Position of the voted-for candidate, -1 if none
+    int32_t getVotedCandidate(uint32_t p) const { return votedCandidate[p].load(memory_order_acquire); }
+    
+    bool getHasVoted(uint32_t p) const {
+        return (votedBits[p / 64].load(memory_order_acquire) >> (p % 64)) & 1;
+    }
+    
+    // Candidate ID, or "" while the vote is being recorded (or unknown)
+    string getVotedFor(uint32_t p) const {
+        int32_t candidate = votedCandidate[p].load(memory_order_acquire);
+        if (candidate < 0 || candidates == nullptr) return "";
+        return candidates->getAllData()[candidate].getId();
+    }
+    
+    // Voters who have voted - a popcount over the bitset
+    int countVoted() const {
+        int count = 0;
+        for (const auto& word : votedBits) {
+            count += (int)bitset<64>(word.load(memory_order_relaxed)).count();
+        }
+        return count;
+    }
+    
+    // Largest numeric ID (irregular IDs cannot collide with new ones)
+    uint32_t maxId() const {
+        uint32_t largest = 0;
+        for (uint32_t id : ids) {
+            if (!(id & IRREGULAR_ID)) largest = max(largest, id);
+        }
+        return largest;
+    }
+    
+    // Bytes held by the columns, the arena and the indexes
+    size_t memoryUsage() const {
+        return ids.capacity() * sizeof(uint32_t) + irregularIds.capacity() * sizeof(ArenaRef) + 
+               cnics.capacity() * sizeof(uint64_t) +
+               (usernames.capacity() + passwords.capacity() + names.capacity()) * sizeof(ArenaRef) +
+               votedCandidate.capacity() * sizeof(int32_t) + 
+               (votedBits.capacity() + dirtyBits.capacity()) * sizeof(uint64_t) +
+               arena.memoryUsage() + idIndex.memoryUsage() + cnicIndex.memoryUsage() + 
+               usernameIndex.memoryUsage();
+    }
+    
+    VoterView operator[](uint32_t p) const { return VoterView(this, p); }
+    
+    // Iteration yields a VoterView per voter
+    class const_iterator {
+    private:
+        const VoterStore* store;
+        uint32_t position;
+    public:
+        const_iterator(const VoterStore* s, uint32_t p) : store(s), position(p) {}
+        VoterView operator*() const { return VoterView(store, position); }
+        const_iterator& operator++() { position++; return *this; }
+        bool operator!=(const const_iterator& other) const { return position != other.position; }
+    };
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, (uint32_t)ids.size()); }
+};
+
+// VoterView accessors read straight from the columns
+inline string VoterView::getUsername() const { return string(store->getUsernameView(position)); }
+inline string VoterView::getName() const { return string(store->getNameView(position)); }
+inline string VoterView::getId() const { return store->getId(position); }
+inline string VoterView::getCnic() const { return store->getCnic(position); }
+inline bool VoterView::getHasVoted() const { return store->getHasVoted(position); }
+inline string VoterView::getVotedFor() const { return store->getVotedFor(position); }
+inline uint32_t VoterView::getNumericId() const { return store->getNumericId(position); }
+
+inline bool VoterView::authenticate(const string& un, const string& pw) const {
+    return store->getUsernameView(position) == un && store->getPasswordView(position) == pw;
+}
+
+inline string VoterView::toString() const {
+    return getUsername() + "," + string(store->getPasswordView(position)) + "," + getName() + "," + getId() + 
+           "," + getCnic() + "," + (getHasVoted() ? "1" : "0") + "," + getVotedFor();
+}
+
+inline void VoterView::toSnapshot(vector<string>& strings, vector<long long>& ints) const {
+    strings = {getUsername(), string(store->getPasswordView(position)), getName(), getId(), getCnic(), 
+               getVotedFor()};
+    ints = {getHasVoted() ? 1 : 0};
+}
+
+inline Voter VoterView::toVoter() const {
+    Voter voter(getUsername(), string(store->getPasswordView(position)), getName(), getId(), getCnic());
+    if (getHasVoted()) voter.castVote(getVotedFor());
+    return voter;
+}
+
+/*
+ * ===================================================================
+ * VOTER DISK INDEX - finds voters inside a saved voter file
+ * DATA STRUCTURE CONCEPT: Sorted arrays searched by binary search
+ * Written next to each voter table on save ("<table>.idx"): for the ID,
+ * the username and the CNIC, a sorted array of (key, location) pairs.
+ * The location is a byte offset into the text file or a record number
+ * of the binary snapshot. Both files are memory-mapped, so the lazy
+ * loading mode finds one voter without reading the rest of the roll.
+ * ===================================================================
+ */
+class VoterDiskIndex {
+private:
+    static constexpr uint32_t VERSION = 2;     // 2: only canonical IDs are their own keys
+    static constexpr int COLUMNS = 3;          // id, username, cnic
+    
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t binarySource;
+        uint32_t reserved;
+        uint64_t recordCount;
+        uint64_t sourceSize;                   // Bytes of the voter file it describes
+    };
+    
+    struct Entry {
+        uint64_t key;
+        uint64_t location;
+        bool operator<(const Entry& other) const {
+            return key < other.key || (key == other.key && location < other.location);
+        }
+    };
+    
+    // One saved voter, read in place
+    struct RecordFields {
+        string_view username, password, name, id, cnic, votedFor;
+        bool hasVoted = false;
+    };
+    
+    MappedFile indexFile;
+    MappedFile textSource;
+    unique_ptr<SnapshotReader<VoterView>> snapshotSource;
+    bool binarySource = false;
+    size_t recordCount = 0;
+    const Entry* columns[COLUMNS] = {nullptr, nullptr, nullptr};
+    
+    static int columnOf(const string& indexName) {
+        if (indexName == "id") return 0;
+        if (indexName == "username") return 1;
+        if (indexName == "cnic") return 2;
+        return -1;
+    }
+    
+    // Canonical IDs and regular CNICs are their own keys; other values are hashed
+    // (every hit is confirmed against the record)
+    static uint64_t keyOf(int column, string_view value) {
+        uint32_t id = 0;
+        if (column == 0 && VoterStore::packId(value, id)) return id;
+        uint64_t number = 0;
+        if (column == 2 && VoterStore::packCnic(value, number)) return number;
+        return hash<string_view>()(value) | (1ULL << 63);
+    }
+    
+    static string_view fieldOf(int column, const RecordFields& record) {
+        return column == 0 ? record.id : column == 1 ? record.username : record.cnic;
+    }
+    
+    bool openSource(const string& sourceFilename, bool binary) {
+        binarySource = binary;
+        if (binary) {
+            snapshotSource.reset(new SnapshotReader<VoterView>());
+            if (!snapshotSource->open(sourceFilename)) return false;
+            recordCount = snapshotSource->size();
+            return true;
+        }
+        return textSource.open(sourceFilename);
+    }
+    
+    size_t sourceSize(const string& sourceFilename) const {
+        error_code error;
+        uintmax_t size = filesystem::file_size(sourceFilename, error);
+        return error ? 0 : (size_t)size;
+    }
+    
+    RecordFields fieldsAt(uint64_t location) const {
+        RecordFields record;
+        if (binarySource) {
+            SnapshotRecord row = snapshotSource->record((size_t)location);
+            record.username = row.getString(0);
+            record.password = row.getString(1);
+            record.name = row.getString(2);
+            record.id = row.getString(3);
+            record.cnic = row.getString(4);
+            record.votedFor = row.getString(5);
+            record.hasVoted = row.getInt(0) != 0;
+            return record;
+        }
+        string_view text(textSource.data(), textSource.size());
+        size_t newline = text.find('\n', location);
+        string_view line = text.substr(location, newline == string_view::npos ? string_view::npos : newline - location);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        FieldTokenizer fields(line);
+        record.username = fields.next();
+        record.password = fields.next();
+        record.name = fields.next();
+        record.id = fields.next();
+        record.cnic = fields.next();
+        record.hasVoted = fields.next() == "1";
+        record.votedFor = fields.next();
+        return record;
+    }
+    
+    // Location of every record of the source, in file order
+    vector<uint64_t> allLocations() const {
+        vector<uint64_t> locations;
+        if (binarySource) {
+            for (size_t i = 0; i < recordCount; i++) locations.push_back(i);
+        } else {
+            string_view text(textSource.data(), textSource.size());
+            forEachLine(text, 0, text.size(), [&](string_view line) { 
+                locations.push_back((uint64_t)(line.data() - text.data())); 
+            });
+        }
+        return locations;
+    }
+
+public:
+    static constexpr uint64_t npos = UINT64_MAX;
+    
+    // Index the voter file that was just saved (written like the other
+    // derived files). Returns false if it cannot be read.
+    static bool build(const string& indexFilename, const string& sourceFilename, bool binary) {
+        VoterDiskIndex source;
+        error_code error;
+        if (!source.openSource(sourceFilename, binary)) {
+            filesystem::remove(indexFilename, error); // An empty roll needs no index
+            return false;
+        }
+        vector<uint64_t> locations = source.allLocations();
+        vector<Entry> entries[COLUMNS];
+        for (int c = 0; c < COLUMNS; c++) {
+            entries[c].reserve(locations.size());
+        }
+        for (uint64_t location : locations) {
+            RecordFields record = source.fieldsAt(location);
+            for (int c = 0; c < COLUMNS; c++) {
+                entries[c].push_back(Entry{keyOf(c, fieldOf(c, record)), location});
+            }
+        }
+        
+        FileHeader header = {{'D', 'V', 'V', 'I'}, VERSION, binary ? 1u : 0u, 0, locations.size(), 
+                             source.sourceSize(sourceFilename)};
+        {
+            ofstream file(temporaryFile(indexFilename), ios::binary | ios::trunc);
+            file.write((const char*)&header, sizeof(header));
+            for (int c = 0; c < COLUMNS; c++) {
+                sort(entries[c].begin(), entries[c].end());
+                file.write((const char*)entries[c].data(), entries[c].size() * sizeof(Entry));
+            }
+            if (!file) return false;
+        }
+        return commitFile(indexFilename);
+    }
+    
+    // Map an index and the voter file it was built from; refused if
+    // either does not match the other
+    bool open(const string& indexFilename, const string& sourceFilename, bool binary) {
+        if (!indexFile.open(indexFilename) || indexFile.size() < sizeof(FileHeader)) return false;
+        FileHeader header;
+        memcpy(&header, indexFile.data(), sizeof(header));
+        if (memcmp(header.magic, "DVVI", 4) != 0 || header.version != VERSION || 
+            header.binarySource != (binary ? 1u : 0u) || header.sourceSize != sourceSize(sourceFilename) ||
+            indexFile.size() != sizeof(FileHeader) + header.recordCount * COLUMNS * sizeof(Entry) ||
+            !openSource(sourceFilename, binary) || (binary && recordCount != header.recordCount)) {
+            close();
+            return false;
+        }
+        recordCount = (size_t)header.recordCount;
+        const Entry* entries = (const Entry*)(indexFile.data() + sizeof(FileHeader));
+        for (int c = 0; c < COLUMNS; c++) {
+            columns[c] = entries + c * recordCount;
+        }
+        return true;
+    }
+    
+    void close() {
+        indexFile.close();
+        textSource.close();
+        snapshotSource.reset();
+        recordCount = 0;
+    }
+    
+    size_t size() const { return recordCount; }
+    
+    // Largest numeric voter ID in the file (0 if none) - canonical IDs
+    // are their own keys and sort before the hashed ones
+    uint64_t maxNumericId() const {
+        if (recordCount == 0) return 0;
+        const Entry* end = lower_bound(columns[0], columns[0] + recordCount, Entry{UINT32_MAX, 0});
+        return end == columns[0] ? 0 : (end - 1)->key;
+    }
+    
+    // Location of the voter whose 'indexName' key matches, or npos
+    uint64_t find(const string& indexName, string_view key) const {
+        int c = columnOf(indexName);
+        if (c < 0 || recordCount == 0) return npos;
+        Entry probe = {keyOf(c, key), 0};
+        const Entry* end = columns[c] + recordCount;
+        for (const Entry* e = lower_bound(columns[c], end, probe); e != end && e->key == probe.key; e++) {
+            if (c == 0 && !(probe.key >> 63)) return e->location; // Numeric IDs are exact keys
+            string_view stored = fieldOf(c, fieldsAt(e->location));
+            // CNICs compare by digits, like the voter store's CNIC index
+            uint64_t a = 0, b = 0;
+            bool packed = c == 2 && VoterStore::packCnic(stored, a) && VoterStore::packCnic(key, b);
+            if (packed ? a == b : stored == key) return e->location;
+        }
+        return npos;
+    }
+    
+    // Copy the record at 'location' into 'store' and index it there
+    void pageIn(uint64_t location, VoterStore& store) const {
+        RecordFields record = fieldsAt(location);
+        store.addFields(record.username, record.password, record.name, record.id, record.cnic, 
+                        record.hasVoted, record.votedFor);
+    }
+};
+
+/*
+ * ===================================================================
+ * CNIC FILTER - blocked Bloom filter in front of the CNIC indexes
+ * DATA STRUCTURE CONCEPT: Bloom filter (probabilistic set membership)
+ * A CNIC sets BITS_PER_KEY_SET bits inside one 512-bit block (a cache
+ * line), so a lookup reads one block. "No" is always right; "maybe" is
+ * confirmed against the records. Sized from the roll at load time and
+ * rebuilt larger when it fills up.
+ * ===================================================================
+ */
+class CnicFilter {
+private:
+    static constexpr size_t BLOCK_WORDS = 8;          // 8 x 64 = 512 bits
+    static constexpr size_t BITS_PER_KEY = 12;         // ~0.5% false positives when full
+    static constexpr int BITS_PER_KEY_SET = 6;
+    static constexpr size_t MIN_CAPACITY = 4096;
+    static constexpr uint32_t FILE_VERSION = 1;
+    
+    vector<CopyableAtomic<uint64_t>> words;
+    size_t blockCount = 0;
+    size_t capacity = 0;                               // Keys the filter was sized for
+    atomic<size_t> keyCount{0};
+    
+    // Lookup outcomes (keys that were absent decide the false-positive rate)
+    mutable atomic<long long> filteredOut{0};          // Answered "no" by the filter
+    mutable atomic<long long> falsePositives{0};       // "Maybe", but not in the records
+    mutable atomic<long long> confirmed{0};            // "Maybe", and in the records
+    
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t blockCount;
+        uint64_t capacity;
+        uint64_t keyCount;
+    };
+    
+    static uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+    
+    // Regular CNICs hash by value, so "35202-1234567-1" and "3520212345671" match
+    static uint64_t hashCnic(string_view cnic) {
+        uint64_t packed = 0;
+        if (VoterStore::packCnic(cnic, packed)) return mix(packed);
+        return mix(hash<string_view>()(cnic) ^ 0x9E3779B97F4A7C15ULL);
+    }
+    
+    // Block from the high half of the hash, bit numbers (9 bits each) from the low half
+    size_t blockOf(uint64_t h) const { return (size_t)(((h >> 32) * blockCount) >> 32); }
+    static uint64_t bitHash(uint64_t h) { return mix(h + 0x9E3779B97F4A7C15ULL); }
+
+public:
+    CnicFilter() { reset(0); }
+    
+    // Empty filter with room for 'expectedKeys' plus as many again
+    void reset(size_t expectedKeys) {
+        capacity = max(MIN_CAPACITY, expectedKeys * 2);
+        blockCount = (capacity * BITS_PER_KEY + 511) / 512;
+        words.assign(blockCount * BLOCK_WORDS, CopyableAtomic<uint64_t>(0));
+        keyCount = 0;
+    }
+    
+    // Safe alongside lookups; callers serialize adds among themselves
+    void add(string_view cnic) {
+        uint64_t h = hashCnic(cnic);
+        CopyableAtomic<uint64_t>* block = &words[blockOf(h) * BLOCK_WORDS];
+        uint64_t bits = bitHash(h);
+        for (int i = 0; i < BITS_PER_KEY_SET; i++, bits >>= 9) {
+            block[(bits >> 6) & 7].fetch_or(1ULL << (bits & 63), memory_order_relaxed);
+        }
+        keyCount.fetch_add(1, memory_order_relaxed);
+    }
+    
+    bool mightContain(string_view cnic) const {
+        uint64_t h = hashCnic(cnic);
+        const CopyableAtomic<uint64_t>* block = &words[blockOf(h) * BLOCK_WORDS];
+        uint64_t bits = bitHash(h);
+        for (int i = 0; i < BITS_PER_KEY_SET; i++, bits >>= 9) {
+            if (!(block[(bits >> 6) & 7].load(memory_order_relaxed) & (1ULL << (bits & 63)))) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Record how a lookup ended, for the false-positive rate
+    void recordLookup(bool passedFilter, bool found) const {
+        if (!passedFilter) {
+            filteredOut.fetch_add(1, memory_order_relaxed);
+        } else if (found) {
+            confirmed.fetch_add(1, memory_order_relaxed);
+        } else {
+            falsePositives.fetch_add(1, memory_order_relaxed);
+        }
+    }
+    
+    bool needsGrow() const { return keyCount.load(memory_order_relaxed) > capacity; }
+    size_t getKeyCount() const { return keyCount.load(memory_order_relaxed); }
+    size_t memoryUsage() const { return words.size() * sizeof(uint64_t); }
+    long long getFilteredOut() const { return filteredOut.load(memory_order_relaxed); }
+    long long getFalsePositives() const { return falsePositives.load(memory_order_relaxed); }
+    long long getConfirmed() const { return confirmed.load(memory_order_relaxed); }
+    
+    // Share of absent CNICs that still needed the exact check
+    double falsePositiveRate() const {
+        long long negatives = getFilteredOut() + getFalsePositives();
+        return negatives == 0 ? 0.0 : (double)getFalsePositives() / negatives;
+    }
+    
+    // Binary file: header, then the bit array
+    string serialize() const {
+        FileHeader header = {{'D', 'V', 'B', 'F'}, FILE_VERSION, blockCount, capacity, getKeyCount()};
+        string contents((const char*)&header, sizeof(header));
+        contents.resize(sizeof(header) + words.size() * sizeof(uint64_t));
+        for (size_t i = 0; i < words.size(); i++) {
+            uint64_t word = words[i].load(memory_order_relaxed);
+            memcpy(&contents[sizeof(header) + i * sizeof(word)], &word, sizeof(word));
+        }
+        return contents;
+    }
+    
+    bool saveToFile(const string& filename) const {
+        return writeFile(filename, serialize());
+    }
+    
+    // Load a saved filter; refused unless it holds exactly 'expectedKeys'
+    bool loadFromFile(const string& filename, size_t expectedKeys) {
+        ifstream file(filename, ios::binary);
+        FileHeader header;
+        if (!file || !file.read((char*)&header, sizeof(header)) || memcmp(header.magic, "DVBF", 4) != 0 ||
+            header.version != FILE_VERSION || header.keyCount != expectedKeys || header.blockCount == 0 ||
+            header.capacity < header.keyCount) {
+            return false;
+        }
+        vector<uint64_t> plain(header.blockCount * BLOCK_WORDS);
+        if (!file.read((char*)plain.data(), plain.size() * sizeof(uint64_t))) return false;
+        blockCount = header.blockCount;
+        capacity = header.capacity;
+        words.assign(plain.begin(), plain.end());
+        keyCount = header.keyCount;
+        return true;
+    }
+};
+
+/*
+ * ===================================================================
+ * VOTE JOURNAL CLASS - Append-only write-ahead log
+ * DATA STRUCTURE CONCEPT: Log (records are only ever appended) fed by a
+ * bounded queue (producer/consumer)
+ * Every vote and registration is appended as one short line instead of
+ * rewriting the data files. Callers only queue the record; a writer
+ * thread takes everything queued so far and writes it with one write,
+ * so voting threads and the menu never wait for the disk. Disk syncs
+ * are batched (group commit): fsync runs once per commit window. When
+ * the queue is full, callers wait for the writer (back-pressure).
+ * ===================================================================
+ */
+class VoteJournal {
+private:
+    string filename;
+    FILE* file;                  // Used by the writer thread only
+    int commitWindowMs;          // 0 = sync after every batch
+    chrono::steady_clock::time_point lastSync;
+    
+    // The queue: formatted records waiting for the writer. Records are
+    // numbered in the order they were queued.
+    mutable mutex queueMutex;
+    condition_variable workReady;      // Writer: records, a flush or a new file
+    condition_variable spaceFree;      // Producers: the queue has room again
+    condition_variable durableChanged; // flush(): more records are on the disk
+    string pending;
+    size_t pendingRecords;
+    size_t capacity;                   // Records the queue holds before callers wait
+    size_t newFileAt;                  // Offset in 'pending' where a new file starts (npos = none)
+    uint64_t queuedCount;              // Records queued so far
+    uint64_t writtenCount;             // ... handed to the OS
+    uint64_t durableCount;             // ... synced to the disk
+    int newFilesRequested, newFilesStarted;
+    long long backPressureWaits;
+    bool syncRequested;
+    bool stopping;
+    thread writer;
+    
+    // Simple FNV-1a checksum so a record torn by a crash is detected
+    static string checksum(const string& text) {
+        unsigned int hash = 2166136261u;
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+        stringstream ss;
+        ss << hex << setw(8) << setfill('0') << hash;
+        return ss.str();
+    }
+    
+    static void formatRecord(string& out, char type, const string& payload) {
+        string body = string(1, type) + "|" + payload;
+        out += body + "|" + checksum(body) + "\n";
+    }
+    
+    // Records of the journal file that a save has started to replace
+    string oldFilename() const { return filename + ".old"; }
+    
+    void enqueue(const string& lines, size_t recordCount) {
+        unique_lock<mutex> lock(queueMutex);
+        if (pendingRecords > 0 && pendingRecords + recordCount > capacity) {
+            backPressureWaits++;
+            spaceFree.wait(lock, [&]() { return pendingRecords == 0 || pendingRecords + recordCount <= capacity; });
+        }
+        pending += lines;
+        pendingRecords += recordCount;
+        queuedCount += recordCount;
+        workReady.notify_one();
+    }
+    
+    // Helpers below run on the writer thread
+    
+    // Force buffered records all the way to the disk
+    void syncToDisk() {
+        if (file != nullptr) {
+            fflush(file);
+#ifdef _WIN32
+            _commit(_fileno(file));
+#else
+            fsync(fileno(file));
+#endif
+        }
+        lastSync = chrono::steady_clock::now();
+    }
+    
+    // A crash during a write can leave a torn record without its '\n' at
+    // the end of a journal file. Cut it off, or the next record would be
+    // appended to the same line and be dropped with it on replay.
+    static void truncateTornRecord(const string& name) {
+        error_code error;
+        uintmax_t size = filesystem::file_size(name, error);
+        if (error || size == 0) return;
+        uintmax_t keep = 0; // Bytes up to and including the last '\n'
+        {
+            ifstream in(name, ios::binary);
+            char buffer[4096];
+            for (uintmax_t end = size; end > 0 && keep == 0;) {
+                uintmax_t begin = end > sizeof(buffer) ? end - sizeof(buffer) : 0;
+                in.seekg((streamoff)begin);
+                if (!in.read(buffer, (streamsize)(end - begin))) return;
+                for (uintmax_t i = end - begin; i > 0 && keep == 0; i--) {
+                    if (buffer[i - 1] == '\n') keep = begin + i;
+                }
+                end = begin;
+            }
+        }
+        if (keep != size) filesystem::resize_file(name, keep, error);
+    }
+    
+    void writeToFile(const char* data, size_t size) {
+        if (size == 0) return;
+        if (file == nullptr) {
+            truncateTornRecord(filename);
+            file = fopen(filename.c_str(), "ab");
+        }
+        if (file == nullptr) return;
+        fwrite(data, 1, size, file);
+        fflush(file); // Survives a process crash from here on
+    }
+    
+    // Move the records written so far to the old file (appended if a
+    // failed save left one) and continue in an empty journal
+    void startNewFile() {
+        syncToDisk();
+        if (file != nullptr) {
+            fclose(file);
+            file = nullptr;
+        }
+        error_code error;
+        if (!filesystem::exists(oldFilename())) {
+            filesystem::rename(filename, oldFilename(), error);
+            return;
+        }
+        truncateTornRecord(oldFilename());
+        {
+            ifstream current(filename, ios::binary);
+            ofstream old(oldFilename(), ios::binary | ios::app);
+            old << current.rdbuf();
+        }
+        syncFile(oldFilename());
+        filesystem::remove(filename, error);
+    }
+    
+    void writerLoop() {
+        unique_lock<mutex> lock(queueMutex);
+        while (true) {
+            bool idle = pending.empty() && newFileAt == string::npos && !syncRequested;
+            if (idle && writtenCount > durableCount) {
+                // Records are waiting for a sync: at the end of the commit window
+                if (stopping || workReady.wait_until(lock, lastSync + chrono::milliseconds(commitWindowMs)) == 
+                                cv_status::timeout) {
+                    syncRequested = true;
+                }
+                continue;
+            }
+            if (idle) {
+                if (stopping) break;
+                workReady.wait(lock);
+                continue;
+            }
+            
+            // Take everything queued so far (one write for many records)
+            string batch;
+            batch.swap(pending);
+            size_t split = newFileAt;
+            uint64_t batchEnd = queuedCount;
+            bool syncNow = syncRequested;
+            pendingRecords = 0;
+            newFileAt = string::npos;
+            syncRequested = false;
+            spaceFree.notify_all();
+            lock.unlock();
+            
+            if (split != string::npos) {
+                writeToFile(batch.data(), split);
+                startNewFile();
+                writeToFile(batch.data() + split, batch.size() - split);
+            } else {
+                writeToFile(batch.data(), batch.size());
+            }
+            auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - lastSync).count();
+            bool synced = syncNow || commitWindowMs <= 0 || elapsed >= commitWindowMs;
+            if (synced) syncToDisk();
+            
+            lock.lock();
+            writtenCount = batchEnd;
+            if (synced) durableCount = batchEnd;
+            if (split != string::npos) newFilesStarted++;
+            durableChanged.notify_all();
+        }
+    }
+
+public:
+    VoteJournal(const string& fn, int windowMs, size_t queueCapacity) 
+        : filename(fn), file(nullptr), commitWindowMs(windowMs), lastSync(chrono::steady_clock::now()), 
+          pendingRecords(0), capacity(max<size_t>(1, queueCapacity)), newFileAt(string::npos), 
+          queuedCount(0), writtenCount(0), durableCount(0), newFilesRequested(0), newFilesStarted(0), 
+          backPressureWaits(0), 
+          syncRequested(false), stopping(false) {
+        writer = thread(&VoteJournal::writerLoop, this);
+    }
+    
+    // Writes and syncs everything still queued
+    ~VoteJournal() {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            stopping = true;
+        }
+        workReady.notify_one();
+        writer.join();
+        if (file != nullptr) fclose(file);
+    }
+    
+    // Queue one record: "<type>|<payload>|<checksum>"
+    void append(char type, const string& payload) {
+        string lines;
+        formatRecord(lines, type, payload);
+        enqueue(lines, 1);
+    }
+    
+    // Queue many records of one type at once (bulk imports)
+    void appendBatch(char type, const vector<string>& payloads) {
+        if (payloads.empty()) return;
+        string lines;
+        for (const string& payload : payloads) {
+            formatRecord(lines, type, payload);
+        }
+        enqueue(lines, payloads.size());
+    }
+    
+    // Flush barrier: returns once every record queued before the call
+    // is synced to the disk
+    void flush() {
+        unique_lock<mutex> lock(queueMutex);
+        uint64_t target = queuedCount;
+        if (durableCount >= target) return;
+        syncRequested = true;
+        workReady.notify_one();
+        durableChanged.wait(lock, [&]() { return durableCount >= target; });
+    }
+    
+    // A save has captured the data: records queued so far stay in the
+    // old file (until discardOldFile()), later ones start a new journal.
+    // Returns the number of records the save contains.
+    uint64_t startNewFileAfterQueued() {
+        lock_guard<mutex> lock(queueMutex);
+        if (newFileAt == string::npos) newFilesRequested++; // Else the later switch covers both
+        newFileAt = pending.size();
+        workReady.notify_one();
+        return queuedCount;
+    }
+    
+    // The save finished: the records it contains are no longer needed
+    void discardOldFile() {
+        {
+            unique_lock<mutex> lock(queueMutex);
+            durableChanged.wait(lock, [&]() { return newFilesStarted == newFilesRequested; });
+        }
+        error_code error;
+        filesystem::remove(oldFilename(), error);
+    }
+    
+    uint64_t getQueuedCount() const {
+        lock_guard<mutex> lock(queueMutex);
+        return queuedCount;
+    }
+    
+    size_t getPendingRecords() const {
+        lock_guard<mutex> lock(queueMutex);
+        return pendingRecords;
+    }
+    
+    long long getBackPressureWaits() const {
+        lock_guard<mutex> lock(queueMutex);
+        return backPressureWaits;
+    }
+    
+    size_t getCapacity() const { return capacity; }
+    
+    // Read back all intact records as (type, payload) pairs: the old
+    // file of an unfinished save first, then the current journal
+    vector<pair<char, string>> readRecords() const {
+        vector<pair<char, string>> records;
+        for (const string& name : {oldFilename(), filename}) {
+            ifstream in(name);
+            string line;
+            while (getline(in, line)) {
+                size_t last = line.rfind('|');
+                if (line.size() < 3 || line[1] != '|' || last == string::npos || last < 2) {
+                    continue; // Malformed or torn record
+                }
+                string body = line.substr(0, last);
+                if (checksum(body) != line.substr(last + 1)) {
+                    continue; // Torn write from a crash - ignore it
+                }
+                records.push_back(make_pair(body[0], body.substr(2)));
+            }
+        }
+        return records;
+    }
+};
+
+/*
+ * ===================================================================
+ * LEADERBOARD CLASS - incrementally maintained ranking
+ * DATA STRUCTURE CONCEPT: Sorted array with bucket boundaries
+ * Items (positions in a DataManager vector) are kept sorted by votes,
+ * highest first. Votes only ever grow by one, so an increment swaps the
+ * item with the first item of its vote bucket and moves the bucket
+ * boundary - O(1) per vote. Top-k and the tie set are read in O(k).
+ * ===================================================================
+ */
+class Leaderboard {
+private:
+    vector<int> order;                  // Items, most votes first
+    vector<int> position;               // position[item] = index in 'order'
+    vector<int> votes;                  // votes[item]
+    unordered_map<int, int> bucketStart; // Vote count -> first index in 'order'
+    mutable mutex boardMutex;           // Votes arrive from many threads
+
+public:
+    // Build from scratch (one sort) - used after loading data
+    void rebuild(const vector<int>& counts) {
+        lock_guard<mutex> lock(boardMutex);
+        votes = counts;
+        order.resize(votes.size());
+        position.resize(votes.size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = (int)i;
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return votes[a] > votes[b]; });
+        
+        bucketStart.clear();
+        for (size_t i = 0; i < order.size(); i++) {
+            position[order[i]] = (int)i;
+            if (i == 0 || votes[order[i]] != votes[order[i - 1]]) {
+                bucketStart[votes[order[i]]] = (int)i;
+            }
+        }
+    }
+    
+    // New item with no votes - it joins the bottom bucket
+    void addItem() {
+        lock_guard<mutex> lock(boardMutex);
+        int item = (int)votes.size();
+        votes.push_back(0);
+        order.push_back(item);
+        position.push_back((int)order.size() - 1);
+        if (bucketStart.find(0) == bucketStart.end()) {
+            bucketStart[0] = (int)order.size() - 1;
+        }
+    }
+    
+    // One more vote for 'item'
+    void increment(int item) {
+        lock_guard<mutex> lock(boardMutex);
+        if (item < 0 || item >= (int)votes.size()) return;
+        int count = votes[item];
+        int first = bucketStart[count];
+        
+        // Move the item to the front of its bucket
+        int other = order[first];
+        swap(order[first], order[position[item]]);
+        position[other] = position[item];
+        position[item] = first;
+        
+        // The old bucket now starts one later (or disappears)
+        if (first + 1 < (int)order.size() && votes[order[first + 1]] == count) {
+            bucketStart[count] = first + 1;
+        } else {
+            bucketStart.erase(count);
+        }
+        
+        // The item becomes the last member of the bucket above (or starts it)
+        votes[item] = count + 1;
+        if (bucketStart.find(count + 1) == bucketStart.end()) {
+            bucketStart[count + 1] = first;
+        }
+    }
+    
+    // The k best items as (item, votes)
+    vector<pair<int, int>> top(size_t k) const {
+        lock_guard<mutex> lock(boardMutex);
+        vector<pair<int, int>> result;
+        for (size_t i = 0; i < order.size() && i < k; i++) {
+            result.push_back(make_pair(order[i], votes[order[i]]));
+        }
+        return result;
+    }
+    
+    // Every item sharing the highest vote count (more than one = a tie)
+    vector<int> leaders() const {
+        lock_guard<mutex> lock(boardMutex);
+        vector<int> result;
+        for (size_t i = 0; i < order.size() && votes[order[i]] == votes[order[0]]; i++) {
+            result.push_back(order[i]);
+        }
+        return result;
+    }
+    
+    // Full ranking, most votes first
+    vector<int> ranking() const {
+        lock_guard<mutex> lock(boardMutex);
+        return order;
+    }
+};
+
+/*
+ * ===================================================================
+ * CONSTITUENCY CLASS - one electoral district, stored as its own shard
+ * DATA STRUCTURE CONCEPT: Partitioning - each constituency has its own
+ * DataManagers, leaderboard, lock and data files, so a vote only
+ * touches the shard of the candidate it is cast for
+ * ===================================================================
+ */
+const string DEFAULT_CONSTITUENCY = "NA-1"; // Used when no constituencies are defined
+
+// File name (without extension) of a constituency's table, e.g. "voters_NA-1"
+string constituencyTable(const string& table, const string& code) {
+    return table + "_" + code;
+}
+
+struct Constituency {
+    string code;                       // Short code such as "NA-1" (used in file names)
+    string name;
+    DataManager<Candidate> candidates; // Changed only under the system-wide exclusive lock
+    VoterStore voters;                 // Changed only under this shard's exclusive lock
+    Leaderboard candidateBoard;        // Live ranking inside this constituency
+    mutable shared_mutex shardMutex;   // Votes in this constituency share it
+    
+    // Lazy loading: voters that are not paged in yet are found through
+    // the index of each voter segment (both changed under the exclusive lock)
+    vector<unique_ptr<VoterDiskIndex>> voterFiles;
+    atomic<bool> votersOnDisk{false};
+    
+    // Segment file holding the voter whose 'indexName' key matches (and
+    // the record's location in it), or nullptr
+    const VoterDiskIndex* findOnDisk(const string& indexName, const string& key, uint64_t& location) const {
+        for (const auto& file : voterFiles) {
+            location = file->find(indexName, key);
+            if (location != VoterDiskIndex::npos) return file.get();
+        }
+        return nullptr;
+    }
+    
+    size_t votersOnDiskCount() const {
+        size_t count = 0;
+        for (const auto& file : voterFiles) count += file->size();
+        return count;
+    }
+    
+    // The voter store indexes ID, CNIC and username itself
+    Constituency(const string& c, const string& n) : code(c), name(n), voters(&candidates) {
+        candidates.addIndex("id", &Candidate::getId);
+        candidates.addIndex("cnic", &Candidate::getCnic);
+    }
+    
+    string toString() const {
+        return code + "," + name;
+    }
+    
+    // Codes become part of file names: letters, digits and '-' only
+    static bool isValidCode(const string& code) {
+        if (code.empty() || code.length() > 10) return false;
+        for (char c : code) {
+            if (!isalnum((unsigned char)c) && c != '-') return false;
+        }
+        return true;
+    }
+};
+
+// Read "code,name" lines of the constituency list (empty if there is none)
+vector<pair<string, string>> readConstituencyList(const string& filename) {
+    vector<pair<string, string>> list;
+    ifstream file(filename);
+    string line;
+    while (getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t comma = line.find(',');
+        if (comma == string::npos || !Constituency::isValidCode(line.substr(0, comma))) continue;
+        list.push_back(make_pair(line.substr(0, comma), line.substr(comma + 1)));
+    }
+    return list;
+}
+
+/*
+ * ===================================================================
+ * ID ALLOCATOR STATE - the next candidate, party and voter IDs
+ * A small binary header saved with every snapshot, so startup reads the
+ * counters instead of parsing every stored ID. Registrations made after
+ * the snapshot carry their ID in the journal record and raise the
+ * counters again when the journal is replayed.
+ * ===================================================================
+ */
+struct IdAllocatorState {
+    static constexpr uint32_t VERSION = 1;
+    
+    int32_t nextCandidateId = 101;
+    int32_t nextPartyId = 201;
+    int32_t nextVoterId = 10001;
+    
+    struct FileLayout {
+        char magic[4];
+        uint32_t version;
+        int32_t nextCandidateId;
+        int32_t nextPartyId;
+        int32_t nextVoterId;
+        uint32_t checksum;
+    };
+    
+    static uint32_t checksum(const FileLayout& layout) {
+        uint32_t hash = 2166136261u; // FNV-1a over everything before the checksum
+        const unsigned char* bytes = (const unsigned char*)&layout;
+        for (size_t i = 0; i < offsetof(FileLayout, checksum); i++) {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+    
+    // Written to a temporary file, synced, then renamed over the old
+    // header, so a crash leaves either the old or the new state
+    bool saveToFile(const string& filename) const {
+        FileLayout layout = {{'D', 'V', 'I', 'D'}, VERSION, nextCandidateId, nextPartyId, nextVoterId, 0};
+        layout.checksum = checksum(layout);
+        return writeFile(filename, string((const char*)&layout, sizeof(layout)));
+    }
+    
+    bool loadFromFile(const string& filename) {
+        ifstream file(filename, ios::binary);
+        FileLayout layout;
+        if (!file || !file.read((char*)&layout, sizeof(layout)) || memcmp(layout.magic, "DVID", 4) != 0 ||
+            layout.version != VERSION || layout.checksum != checksum(layout)) {
+            return false;
+        }
+        nextCandidateId = layout.nextCandidateId;
+        nextPartyId = layout.nextPartyId;
+        nextVoterId = layout.nextVoterId;
+        return true;
+    }
+};
+
+/*
+ * ===================================================================
+ * SYSTEM OPTIONS - start-up settings chosen on the command line
+ * ===================================================================
+ */
+struct SystemOptions {
+    int journalCommitWindowMs = 200; // Group commit window of the journal
+    bool binarySnapshots = false;    // Use .bin snapshots instead of .txt files
+    string dataDirectory = "";       // Where data files live ("" = current directory)
+    bool verifyIdCounters = false;   // Cross-check the saved ID counters in the background
+    bool lazyVoters = false;         // Page voters in on demand instead of loading the roll
+    int saveIntervalMs = 5000;       // Background save period (0 = save only at exit)
+    size_t journalQueueRecords = 8192; // Journal records queued before callers wait
+    int metricsIntervalMs = 10000;   // metrics.prom rewrite period (0 = write only at exit)
+};
+
+// Path of a data file inside the data directory
+string dataFilePath(const string& directory, const string& filename) {
+    return directory.empty() ? filename : directory + "/" + filename;
+}
+
+// Outcome of a vote submitted through ElectionEngine::submitVote
+enum class VoteResult { SUCCESS, ELECTION_CLOSED, UNKNOWN_VOTER, UNKNOWN_CANDIDATE, ALREADY_VOTED, 
+                        WRONG_CONSTITUENCY };
+
+string voteResultText(VoteResult result) {
+    switch (result) {
+        case VoteResult::SUCCESS: return "Accepted";
+        case VoteResult::ELECTION_CLOSED: return "Election not active";
+        case VoteResult::UNKNOWN_VOTER: return "Unknown voter ID";
+        case VoteResult::UNKNOWN_CANDIDATE: return "Unknown candidate ID";
+        case VoteResult::ALREADY_VOTED: return "Voter has already voted";
+        case VoteResult::WRONG_CONSTITUENCY: return "Candidate is not in the voter's constituency";
+    }
+    return "Unknown";
+}
+
+// Totals reported by ElectionEngine::ingestBallots (ballots) and
+// ElectionEngine::runBatch (commands)
+struct BallotImportSummary {
+    long long total = 0;
+    long long accepted = 0;
+    long long rejected = 0;
+    double seconds = 0;
+    string error;        // runBatch: why the command or results file failed ("" = none)
+};
+
+// Outcome of the other typed calls of ElectionEngine
+enum class EngineStatus { OK, INVALID_FIELD, INVALID_CNIC, INVALID_CODE, INVALID_WINDOW, DUPLICATE_USERNAME, 
+                          DUPLICATE_CNIC, DUPLICATE_CODE, UNKNOWN_CONSTITUENCY, UNKNOWN_PARTY, 
+                          ELECTION_NOT_ENDED, MALFORMED_COMMAND, UNKNOWN_COMMAND };
+
+string engineStatusText(EngineStatus status) {
+    switch (status) {
+        case EngineStatus::OK: return "OK";
+        case EngineStatus::INVALID_FIELD: return "Fields may not be empty or contain commas";
+        case EngineStatus::INVALID_CNIC: return "Invalid CNIC format. Please use format: 00000-0000000-0";
+        case EngineStatus::INVALID_CODE: return "Code may only contain letters and digits and '-'";
+        case EngineStatus::INVALID_WINDOW: return "End time must be after start time";
+        case EngineStatus::DUPLICATE_USERNAME: return "Username already exists";
+        case EngineStatus::DUPLICATE_CNIC: return "CNIC already registered in the system";
+        case EngineStatus::DUPLICATE_CODE: return "Constituency code already exists";
+        case EngineStatus::UNKNOWN_CONSTITUENCY: return "Invalid Constituency Code";
+        case EngineStatus::UNKNOWN_PARTY: return "Invalid Party ID";
+        case EngineStatus::ELECTION_NOT_ENDED: return "Election is still ongoing";
+        case EngineStatus::MALFORMED_COMMAND: return "Malformed command";
+        case EngineStatus::UNKNOWN_COMMAND: return "Unknown command";
+    }
+    return "Unknown";
+}
+
+// Pakistani CNIC format: 00000-0000000-0
+bool isValidCnicFormat(const string& cnic) {
+    return parseCnic(cnic) != INVALID_CNIC;
+}
+
+// Seats decided by a tally, copied out so they stay valid after the call
+struct ElectionTally {
+    int totalVotes = 0;
+    map<string, int> seats;               // Party ID (or "Independent") -> seats won
+    int undecidedSeats = 0;               // Ties and constituencies without votes
+    vector<pair<string, string>> winners; // Constituency code -> winning candidate ID ("" = undecided)
+};
+
+// A candidate on a voter's ballot and a voter's status, as returned by
+// ElectionEngine::getBallot and getVoterStatus
+struct BallotEntry {
+    string id, name, party; // Party ID or "Independent"
+};
+
+struct VoterStatus {
+    string constituency;
+    bool hasVoted = false;
+    string votedFor;
+};
+
+/*
+ * ===================================================================
+ * METRICS REGISTRY - counters, gauges and latency histograms
+ * OOP CONCEPT: Polymorphism - the registry writes every kind of metric
+ * through the same Metric interface
+ * Recording never takes a lock: a counter is one relaxed atomic add and
+ * a histogram adds to one of its buckets. Histograms are HDR-style
+ * (log-linear): every power of two of nanoseconds is split into 16
+ * buckets, so any latency from 1 ns to about 18 minutes is kept within
+ * 1/16 of its value in 4.7 KB. The registry is shown in the admin menu
+ * and written in the Prometheus text format.
+ * ===================================================================
+ */
+class Metric {
+protected:
+    string name, help;
+
+public:
+    Metric(const string& metricName, const string& description) : name(metricName), help(description) {}
+    virtual ~Metric() {}
+    
+    const string& getName() const { return name; }
+    const string& getHelp() const { return help; }
+    
+    virtual void writePrometheus(ostream& out) const = 0;
+    virtual void writeSummary(ostream& out) const = 0; // One line of the System Metrics table
+};
+
+class MetricCounter : public Metric {
+private:
+    atomic<uint64_t> value{0};
+
+public:
+    using Metric::Metric;
+    
+    void add(uint64_t amount = 1) { value.fetch_add(amount, memory_order_relaxed); }
+    uint64_t get() const { return value.load(memory_order_relaxed); }
+    
+    void writePrometheus(ostream& out) const override {
+        out << "# HELP " << name << " " << help << "\n# TYPE " << name << " counter\n" << name << " " << get() << "\n";
+    }
+    
+    void writeSummary(ostream& out) const override {
+        out << left << setw(36) << name << right << setw(14) << get() << endl;
+    }
+};
+
+class MetricGauge : public Metric {
+private:
+    atomic<int64_t> value{0};
+
+public:
+    using Metric::Metric;
+    
+    void set(int64_t newValue) { value.store(newValue, memory_order_relaxed); }
+    int64_t get() const { return value.load(memory_order_relaxed); }
+    
+    void writePrometheus(ostream& out) const override {
+        out << "# HELP " << name << " " << help << "\n# TYPE " << name << " gauge\n" << name << " " << get() << "\n";
+    }
+    
+    void writeSummary(ostream& out) const override {
+        out << left << setw(36) << name << right << setw(14) << get() << endl;
+    }
+};
+
+// Latencies in nanoseconds. Values below 32 have a bucket each; above,
+// bucket 16 * s + m holds the values whose top five bits are m (16-31)
+// once shifted right by s.
+class LatencyHistogram : public Metric {
+private:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr uint64_t MAX_TRACKED = (1ULL << 40) - 1; // Longer latencies count as this
+    static constexpr size_t BUCKET_COUNT = (40 - SUB_BUCKET_BITS) * SUB_BUCKETS + SUB_BUCKETS;
+    
+    array<atomic<uint64_t>, BUCKET_COUNT> buckets{};
+    atomic<uint64_t> totalNanoseconds{0};
+    atomic<uint64_t> maxNanoseconds{0};
+    
+    static size_t bucketOf(uint64_t value) {
+        if (value < 2 * SUB_BUCKETS) return (size_t)value;
+        int shift = (63 - countl_zero(value)) - SUB_BUCKET_BITS;
+        return (size_t)shift * SUB_BUCKETS + (size_t)(value >> shift);
+    }
+    
+    // Largest value that falls into 'bucket'
+    static uint64_t bucketLimit(size_t bucket) {
+        if (bucket < 2 * SUB_BUCKETS) return bucket;
+        int shift = (int)(bucket / SUB_BUCKETS) - 1;
+        uint64_t mantissa = bucket - (size_t)shift * SUB_BUCKETS;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+public:
+    using Metric::Metric;
+    
+    void record(uint64_t nanoseconds) {
+        nanoseconds = min(nanoseconds, MAX_TRACKED);
+        buckets[bucketOf(nanoseconds)].fetch_add(1, memory_order_relaxed);
+        totalNanoseconds.fetch_add(nanoseconds, memory_order_relaxed);
+        uint64_t previousMax = maxNanoseconds.load(memory_order_relaxed);
+        while (nanoseconds > previousMax && 
+               !maxNanoseconds.compare_exchange_weak(previousMax, nanoseconds, memory_order_relaxed)) {}
+    }
+    
+    // Copy of the buckets, so every statistic of one report agrees
+    struct Snapshot {
+        vector<uint64_t> counts;
+        uint64_t count = 0, totalNanoseconds = 0, maxNanoseconds = 0;
+        
+        // Upper limit of the bucket holding the p-th percentile (never above the max)
+        uint64_t percentile(double p) const {
+            if (count == 0) return 0;
+            uint64_t rank = max<uint64_t>(1, (uint64_t)ceil(p / 100.0 * count)), seen = 0;
+            for (size_t b = 0; b < counts.size(); b++) {
+                seen += counts[b];
+                if (seen >= rank) return min(bucketLimit(b), maxNanoseconds);
+            }
+            return maxNanoseconds;
+        }
+    };
+    
+    Snapshot snapshot() const {
+        Snapshot result;
+        result.counts.resize(BUCKET_COUNT);
+        for (size_t b = 0; b < BUCKET_COUNT; b++) {
+            result.counts[b] = buckets[b].load(memory_order_relaxed);
+            result.count += result.counts[b];
+        }
+        result.totalNanoseconds = totalNanoseconds.load(memory_order_relaxed);
+        result.maxNanoseconds = maxNanoseconds.load(memory_order_relaxed);
+        return result;
+    }
+    
+    // A Prometheus summary in seconds, plus the maximum as a gauge
+    void writePrometheus(ostream& out) const override {
+        Snapshot data = snapshot();
+        out << "# HELP " << name << " " << help << "\n# TYPE " << name << " summary\n";
+        for (double q : {0.5, 0.9, 0.99, 0.999}) {
+            out << name << "{quantile=\"" << q << "\"} " << data.percentile(q * 100) / 1e9 << "\n";
+        }
+        out << name << "_sum " << data.totalNanoseconds / 1e9 << "\n" << name << "_count " << data.count << "\n";
+        out << "# HELP " << name << "_max Longest observation of " << name << "\n# TYPE " << name << "_max gauge\n" 
+            << name << "_max " << data.maxNanoseconds / 1e9 << "\n";
+    }
+    
+    static void printSummaryHeader(ostream& out) {
+        out << left << setw(36) << "Latency" << right << setw(14) << "Count" << setw(12) << "p50 (us)" 
+            << setw(12) << "p99 (us)" << setw(12) << "p99.9 (us)" << setw(12) << "max (us)" << endl;
+    }
+    
+    void writeSummary(ostream& out) const override {
+        Snapshot data = snapshot();
+        out << left << setw(36) << name << right << setw(14) << data.count << fixed << setprecision(1) 
+            << setw(12) << data.percentile(50) / 1e3 << setw(12) << data.percentile(99) / 1e3 
+            << setw(12) << data.percentile(99.9) / 1e3 << setw(12) << data.maxNanoseconds / 1e3 << endl;
+    }
+};
+
+// Records the time from its construction to the end of its scope
+class LatencyTimer {
+private:
+    LatencyHistogram& histogram;
+    chrono::steady_clock::time_point start;
+
+public:
+    explicit LatencyTimer(LatencyHistogram& target) : histogram(target), start(chrono::steady_clock::now()) {}
+    ~LatencyTimer() {
+        histogram.record((uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+    }
+};
+
+// Owns the metrics; they are created before recording starts and live
+// as long as the registry, so recording code keeps plain references
+class MetricsRegistry {
+private:
+    vector<unique_ptr<Metric>> metrics;
+    mutable mutex registryMutex; // Guards the list, never a recording
+    
+    template<typename M>
+    M& create(const string& name, const string& help) {
+        lock_guard<mutex> lock(registryMutex);
+        metrics.push_back(make_unique<M>(name, help));
+        return static_cast<M&>(*metrics.back());
+    }
+
+public:
+    MetricCounter& counter(const string& name, const string& help) { return create<MetricCounter>(name, help); }
+    MetricGauge& gauge(const string& name, const string& help) { return create<MetricGauge>(name, help); }
+    LatencyHistogram& histogram(const string& name, const string& help) { return create<LatencyHistogram>(name, help); }
+    
+    string formatPrometheus() const {
+        ostringstream out;
+        lock_guard<mutex> lock(registryMutex);
+        for (const auto& metric : metrics) metric->writePrometheus(out);
+        return out.str();
+    }
+    
+    // Counters and gauges first, then one latency table
+    void printSummary(ostream& out) const {
+        lock_guard<mutex> lock(registryMutex);
+        out << left << setw(36) << "Metric" << right << setw(14) << "Value" << endl;
+        out << string(50, '-') << endl;
+        for (const auto& metric : metrics) {
+            if (dynamic_cast<const LatencyHistogram*>(metric.get()) == nullptr) metric->writeSummary(out);
+        }
+        out << endl;
+        LatencyHistogram::printSummaryHeader(out);
+        out << string(98, '-') << endl;
+        for (const auto& metric : metrics) {
+            if (dynamic_cast<const LatencyHistogram*>(metric.get()) != nullptr) metric->writeSummary(out);
+        }
+    }
+};
+
+// Resident memory of this process in bytes (0 where unsupported)
+size_t residentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return counters.WorkingSetSize;
+    return 0;
+#else
+    ifstream statm("/proc/self/statm");
+    size_t totalPages = 0, residentPages = 0;
+    if (!(statm >> totalPages >> residentPages)) return 0;
+    return residentPages * (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+/*
+ * ===================================================================
+ * REPORT WRITERS - one pass over the tally, every output format
+ * OOP CONCEPT: Polymorphism - ElectionEngine::streamReport walks the
+ * rankings once and hands every row to each ReportFormat (the screen,
+ * the text file, the CSV files and the JSON file). Rankings are
+ * positions in the candidate and party tables, so no record is copied,
+ * and every format appends to a large buffer that is written out in
+ * big blocks instead of being flushed line by line.
+ * ===================================================================
+ */
+
+// Result of one constituency, tallied independently of the others
+struct ConstituencyResult {
+    Constituency* shard = nullptr;
+    int registered = 0;
+    int turnout = 0;      // Voters who have voted
+    int totalVotes = 0;
+    vector<int> ranking;  // Candidate positions, most votes first
+    vector<int> winners;  // More than one = tie (empty if nobody voted)
+};
+
+// Formatted output collected in memory and written to its stream about
+// once a megabyte. pad() left-aligns in a field like setw() after
+// 'left'; numbers go through to_chars, which rounds like printf.
+class ReportBuffer {
+private:
+    static const size_t FLUSH_BYTES = 1 << 20;
+    ofstream file;
+    ostream* target;
+    string buffer;
+    
+    // Called at line ends only, so pad() always sees its whole field
+    void flushIfFull() {
+        if (buffer.size() >= FLUSH_BYTES) flush();
+    }
+
+public:
+    explicit ReportBuffer(ostream& out) : target(&out) { buffer.reserve(FLUSH_BYTES + 4096); }
+    explicit ReportBuffer(const string& filename) : file(filename, ios::binary | ios::trunc), target(&file) {
+        buffer.reserve(FLUSH_BYTES + 4096);
+    }
+    ~ReportBuffer() { flush(); }
+    
+    bool isOpen() const { return target != &file || file.is_open(); }
+    
+    ReportBuffer& operator<<(string_view text) {
+        buffer.append(text);
+        return *this;
+    }
+    
+    ReportBuffer& operator<<(char c) {
+        buffer += c;
+        if (c == '\n') flushIfFull();
+        return *this;
+    }
+    
+    template<typename Integer> requires is_integral_v<Integer>
+    ReportBuffer& operator<<(Integer value) {
+        char digits[24];
+        buffer.append(digits, to_chars(digits, digits + sizeof(digits), value).ptr);
+        return *this;
+    }
+    
+    // 'value' with 'decimals' digits after the point. Percentages take a
+    // shortcut: scaled by 10^decimals they are off by far less than 1e-6,
+    // so unless the scaled value is that close to a tie, rounding it gives
+    // the digits printf would; everything else goes through to_chars.
+    ReportBuffer& fixed(double value, int decimals) {
+        static const uint64_t powers[] = {1, 10, 100, 1000};
+        if (value >= 0 && value < 1e6 && decimals >= 0 && decimals <= 3) {
+            double scaled = value * (double)powers[decimals];
+            double whole = floor(scaled);
+            double fraction = scaled - whole;
+            if (fabs(fraction - 0.5) > 1e-6) {
+                uint64_t rounded = (uint64_t)whole + (fraction > 0.5 ? 1 : 0);
+                *this << rounded / powers[decimals];
+                if (decimals > 0) {
+                    char digits[4];
+                    uint64_t rest = rounded % powers[decimals];
+                    for (int d = decimals - 1; d >= 0; d--, rest /= 10) digits[d] = (char)('0' + rest % 10);
+                    buffer += '.';
+                    buffer.append(digits, decimals);
+                }
+                return *this;
+            }
+        }
+        char digits[320]; // Room for any double
+        buffer.append(digits, to_chars(digits, digits + sizeof(digits), value, chars_format::fixed, decimals).ptr);
+        return *this;
+    }
+    
+    ReportBuffer& fill(char c, size_t count) {
+        buffer.append(count, c);
+        return *this;
+    }
+    
+    // 'value' left-aligned in 'width' characters (longer values are not cut)
+    template<typename Value>
+    ReportBuffer& pad(const Value& value, size_t width) {
+        size_t start = buffer.size();
+        *this << value;
+        return padFrom(start, width);
+    }
+    
+    ReportBuffer& padFixed(double value, int decimals, size_t width) {
+        size_t start = buffer.size();
+        fixed(value, decimals);
+        return padFrom(start, width);
+    }
+    
+    ReportBuffer& padFrom(size_t start, size_t width) {
+        size_t written = buffer.size() - start;
+        if (written < width) buffer.append(width - written, ' ');
+        return *this;
+    }
+    
+    // 'text' as a JSON string literal
+    ReportBuffer& jsonString(string_view text) {
+        buffer += '"';
+        appendJsonEscaped(buffer, text);
+        buffer += '"';
+        return *this;
+    }
+    
+    // 'text' as a CSV field, quoted only when it has to be
+    ReportBuffer& csvField(string_view text) {
+        bool plain = true;
+        for (char c : text) plain = plain && c != ',' && c != '"' && c != '\r' && c != '\n';
+        if (plain) return *this << text;
+        buffer += '"';
+        for (char c : text) {
+            if (c == '"') buffer += '"';
+            buffer += c;
+        }
+        buffer += '"';
+        return *this;
+    }
+    
+    // Write out what is buffered; false if the stream has failed
+    bool flush() {
+        if (!buffer.empty()) {
+            target->write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+        target->flush();
+        return !target->fail();
+    }
+};
+
+// What a report knows before its first row
+struct ReportTotals {
+    time_t generatedAt = 0;
+    ElectionTally tally;        // Votes and seats (ElectionEngine::countSeats)
+    size_t constituencies = 0, candidates = 0, parties = 0;
+    size_t largestParties = 0;  // Parties with the most seats (more than one = tie)
+    int mostSeats = 0;
+    string largestPartyName;    // When there is exactly one
+};
+
+// The steps of a report, in the order ElectionEngine::streamReport calls
+// them. Every step does nothing unless a format overrides it.
+class ReportFormat {
+protected:
+    static string_view partyLabel(const Candidate& candidate) {
+        return candidate.getIsIndependent() ? string_view("Independent") : string_view(candidate.getPartyId());
+    }
+
+public:
+    virtual ~ReportFormat() {}
+    virtual void beginReport(const ReportTotals&) {}
+    virtual void beginConstituency(const ConstituencyResult&) {}
+    // 'rank' counts from 1; 'percentage' is of the constituency's votes
+    virtual void candidateRow(const ConstituencyResult&, size_t, const Candidate&, double) {}
+    virtual void endConstituency(const ConstituencyResult&) {}
+    virtual void beginParties(size_t) {}
+    virtual void partyRow(size_t, const Party&, double, int) {}
+    virtual void endReport(const ReportTotals&) {}
+    // Write out everything; false if a file could not be written
+    virtual bool finish() = 0;
+};
+
+// The report on the screen
+class ConsoleReport : public ReportFormat {
+private:
+    ReportBuffer out;
+
+public:
+    explicit ConsoleReport(ostream& stream) : out(stream) {}
+    
+    void beginConstituency(const ConstituencyResult& result) override {
+        out << "\n=== " << result.shard->code << " - " << result.shard->name << " ===\n";
+        out << "Registered Voters: " << result.registered << ", Votes Cast: " << result.totalVotes;
+        if (result.registered > 0) {
+            out << " (Turnout ";
+            out.fixed((double)result.turnout / result.registered * 100, 1) << "%)";
+        }
+        out << '\n';
+        if (result.totalVotes == 0) {
+            out << "No votes cast in this constituency.\n";
+            return;
+        }
+        
+        out << "\n=== CANDIDATE RESULTS (Sorted by Votes) ===\n";
+        out.pad("Rank", 5).pad("ID", 10).pad("Name", 20).pad("Party/Type", 15).pad("Votes", 8).pad("Percentage", 12) << '\n';
+        out.fill('-', 70) << '\n';
+    }
+    
+    void candidateRow(const ConstituencyResult& result, size_t rank, const Candidate& candidate, 
+                      double percentage) override {
+        if (result.totalVotes == 0) return;
+        out.pad(rank, 5).pad(candidate.getId(), 10).pad(candidate.getName(), 20).pad(partyLabel(candidate), 15)
+           .pad(candidate.getVotes(), 8).padFixed(percentage, 1, 12) << "%" << '\n';
+    }
+    
+    // Winner announcement - handle ties (the leaderboard's top bucket)
+    void endConstituency(const ConstituencyResult& result) override {
+        if (result.totalVotes == 0) return;
+        const vector<Candidate>& allCandidates = result.shard->candidates.getAllData();
+        const Candidate& topCandidate = allCandidates[result.winners[0]];
+        if (result.winners.size() == 1) {
+            out << "Winner: " << topCandidate.getName() << " (ID: " << topCandidate.getId() << ")\n";
+            out << "Votes: " << topCandidate.getVotes() << " (";
+            out.fixed((double)topCandidate.getVotes() / result.totalVotes * 100, 1) << "%)\n";
+            if (!topCandidate.getIsIndependent()) {
+                out << "Party: " << topCandidate.getPartyId() << '\n';
+            } else {
+                out << "Independent Candidate\n";
+            }
+            return;
+        }
+        out << "TIE RESULT - " << result.winners.size() << " candidates tied with " 
+            << topCandidate.getVotes() << " votes each:\n";
+        for (int index : result.winners) {
+            const Candidate& winner = allCandidates[index];
+            out << "- " << winner.getName() << " (ID: " << winner.getId() << ")";
+            if (!winner.getIsIndependent()) {
+                out << " (Party: " << winner.getPartyId() << ")";
+            } else {
+                out << " (Independent)";
+            }
+            out << '\n';
+        }
+        out << "A runoff election may be required.\n";
+    }
+    
+    void beginParties(size_t count) override {
+        if (count == 0) return;
+        out << "\n=== PARTY-WISE RESULTS ===\n";
+        out.pad("Rank", 5).pad("ID", 10).pad("Name", 25).pad("Votes", 8).pad("Percentage", 12).pad("Seats", 6) << '\n';
+        out.fill('-', 66) << '\n';
+    }
+    
+    void partyRow(size_t rank, const Party& party, double percentage, int seats) override {
+        out.pad(rank, 5).pad(party.getId(), 10).pad(party.getName(), 25).pad(party.getTotalVotes(), 8)
+           .padFixed(percentage, 1, 11) << "%";
+        out.pad(seats, 6) << '\n';
+    }
+    
+    // Seat summary across all constituencies
+    void endReport(const ReportTotals& totals) override {
+        const ElectionTally& tally = totals.tally;
+        out << "\n=== ELECTION RESULT ===\n";
+        out << "Constituencies: " << totals.constituencies << '\n';
+        auto independents = tally.seats.find("Independent");
+        if (independents != tally.seats.end()) {
+            out << "Seats won by independents: " << independents->second << '\n';
+        }
+        if (tally.undecidedSeats > 0) {
+            out << "Seats undecided (tie or no votes): " << tally.undecidedSeats << '\n';
+        }
+        if (totals.largestParties == 1) {
+            out << "Largest Party: " << totals.largestPartyName << " (" << totals.mostSeats << " of " 
+                << totals.constituencies << " seats)\n";
+        } else if (totals.largestParties > 1) {
+            out << totals.largestParties << " parties tied with " << totals.mostSeats << " seats each.\n";
+        }
+    }
+    
+    bool finish() override { return out.flush(); }
+};
+
+// election_report.txt - the printable summary
+class TextReport : public ReportFormat {
+private:
+    ReportBuffer out;
+
+public:
+    explicit TextReport(const string& filename) : out(filename) {}
+    
+    void beginReport(const ReportTotals& totals) override {
+        out << "ELECTION REPORT - Generated on: " << ctime(&totals.generatedAt) << '\n';
+        out.fill('=', 50) << '\n';
+        out << "Total Votes Cast: " << totals.tally.totalVotes << '\n';
+        out << "Total Constituencies: " << totals.constituencies << '\n';
+        out << "Total Candidates: " << totals.candidates << '\n';
+        out << "Total Parties: " << totals.parties << '\n';
+    }
+    
+    void beginConstituency(const ConstituencyResult& result) override {
+        out << '\n' << result.shard->code << " - " << result.shard->name << " RESULTS:\n";
+    }
+    
+    void candidateRow(const ConstituencyResult&, size_t rank, const Candidate& candidate, double percentage) override {
+        out << rank << ". " << candidate.getName() << " - " << candidate.getVotes() << " votes (";
+        out.fixed(percentage, 1) << "%)\n";
+    }
+    
+    void endConstituency(const ConstituencyResult& result) override {
+        if (result.winners.size() == 1) {
+            out << "WINNER: " << result.shard->candidates.getAllData()[result.winners[0]].getName() << '\n';
+        } else {
+            out << "WINNER: undecided\n";
+        }
+    }
+    
+    void endReport(const ReportTotals& totals) override {
+        out << "\nSEATS:\n";
+        for (const auto& entry : totals.tally.seats) {
+            out << entry.first << ": " << entry.second << '\n';
+        }
+    }
+    
+    bool finish() override { return out.isOpen() && out.flush(); }
+};
+
+// election_report.csv (one row per candidate) and
+// election_report_parties.csv (one row per party), for spreadsheets
+class CsvReport : public ReportFormat {
+private:
+    ReportBuffer candidates;
+    ReportBuffer parties;
+
+public:
+    CsvReport(const string& candidateFile, const string& partyFile) : candidates(candidateFile), parties(partyFile) {}
+    
+    void beginReport(const ReportTotals&) override {
+        candidates << "constituency,rank,candidate_id,name,party,votes,percentage,result\n";
+        parties << "rank,party_id,name,votes,percentage,seats\n";
+    }
+    
+    // 'result' is "won" or "tied" for the candidates sharing the top
+    void candidateRow(const ConstituencyResult& result, size_t rank, const Candidate& candidate, 
+                      double percentage) override {
+        candidates.csvField(result.shard->code) << ',' << rank << ',';
+        candidates.csvField(candidate.getId()) << ',';
+        candidates.csvField(candidate.getName()) << ',';
+        candidates.csvField(partyLabel(candidate)) << ',' << candidate.getVotes() << ',';
+        candidates.fixed(percentage, 2) << ',';
+        if (rank <= result.winners.size()) candidates << (result.winners.size() == 1 ? "won" : "tied");
+        candidates << '\n';
+    }
+    
+    void partyRow(size_t rank, const Party& party, double percentage, int seats) override {
+        parties << rank << ',';
+        parties.csvField(party.getId()) << ',';
+        parties.csvField(party.getName()) << ',' << party.getTotalVotes() << ',';
+        parties.fixed(percentage, 2) << ',' << seats << '\n';
+    }
+    
+    bool finish() override {
+        bool written = candidates.isOpen() && candidates.flush();
+        return parties.isOpen() && parties.flush() && written;
+    }
+};
+
+// election_report.json - the whole result for other programs; one
+// candidate or party object per line
+class JsonReport : public ReportFormat {
+private:
+    ReportBuffer out;
+    bool firstItem = true;
+    
+    void separator() {
+        if (!firstItem) out << ',';
+        out << '\n';
+        firstItem = false;
+    }
+
+public:
+    explicit JsonReport(const string& filename) : out(filename) {}
+    
+    void beginReport(const ReportTotals& totals) override {
+        out << "{\"generatedAt\":" << (long long)totals.generatedAt << ",\"totalVotes\":" << totals.tally.totalVotes 
+            << ",\"candidates\":" << totals.candidates << ",\"parties\":" << totals.parties 
+            << ",\n\"constituencies\":[";
+        firstItem = true;
+    }
+    
+    void beginConstituency(const ConstituencyResult& result) override {
+        separator();
+        out << "{\"code\":";
+        out.jsonString(result.shard->code) << ",\"name\":";
+        out.jsonString(result.shard->name) << ",\"registered\":" << result.registered << ",\"voted\":" 
+            << result.turnout << ",\"votes\":" << result.totalVotes << ",\"candidates\":[";
+        firstItem = true;
+    }
+    
+    void candidateRow(const ConstituencyResult&, size_t rank, const Candidate& candidate, double percentage) override {
+        separator();
+        out << "{\"rank\":" << rank << ",\"id\":";
+        out.jsonString(candidate.getId()) << ",\"name\":";
+        out.jsonString(candidate.getName()) << ",\"party\":";
+        if (candidate.getIsIndependent()) {
+            out << "null";
+        } else {
+            out.jsonString(candidate.getPartyId());
+        }
+        out << ",\"votes\":" << candidate.getVotes() << ",\"percentage\":";
+        out.fixed(percentage, 2) << '}';
+    }
+    
+    // More than one winner = tie; none = nobody voted
+    void endConstituency(const ConstituencyResult& result) override {
+        out << "\n],\"winners\":[";
+        for (size_t i = 0; i < result.winners.size(); i++) {
+            if (i > 0) out << ',';
+            out.jsonString(result.shard->candidates.getAllData()[result.winners[i]].getId());
+        }
+        out << "]}";
+        firstItem = false;
+    }
+    
+    void beginParties(size_t) override {
+        out << "\n],\n\"parties\":[";
+        firstItem = true;
+    }
+    
+    void partyRow(size_t rank, const Party& party, double percentage, int seats) override {
+        separator();
+        out << "{\"rank\":" << rank << ",\"id\":";
+        out.jsonString(party.getId()) << ",\"name\":";
+        out.jsonString(party.getName()) << ",\"votes\":" << party.getTotalVotes() << ",\"percentage\":";
+        out.fixed(percentage, 2) << ",\"seats\":" << seats << '}';
+    }
+    
+    void endReport(const ReportTotals& totals) override {
+        out << "\n],\n\"seats\":{";
+        bool first = true;
+        for (const auto& entry : totals.tally.seats) {
+            if (!first) out << ',';
+            out.jsonString(entry.first) << ':' << entry.second;
+            first = false;
+        }
+        out << "},\"undecidedSeats\":" << totals.tally.undecidedSeats << "}\n";
+    }
+    
+    bool finish() override { return out.isOpen() && out.flush(); }
+};
+
+/*
+ * ===================================================================
+ * ELECTION ENGINE - the voting system without a user interface
+ * OOP CONCEPT: Composition - ElectionEngine HAS-A DataManager, Admin, Timer
+ * Typed calls (createParty, createCandidate, registerVoterAccount,
+ * submitVote, setElectionWindow, tally) validate their arguments and
+ * return status codes. Nothing here reads the console, so scripts and
+ * the batch runner drive it at full speed.
+ * ===================================================================
+ */
+class ElectionEngine {
+protected:
+    // OOP CONCEPT: Composition relationships
+    vector<unique_ptr<Constituency>> constituencies; // HAS-A relationship (one shard each)
+    DataManager<Party> parties;        // HAS-A relationship
+    Admin admin;                       // HAS-A relationship
+    ElectionTimer timer;               // HAS-A relationship
+    VoteJournal journal;               // Write-ahead log of changes since the last save
+    SystemOptions options;
+    ostream* warningLog;               // Missing segments and failed saves (nullptr = not reported)
+    atomic<int> nextCandidateId;
+    atomic<int> nextPartyId; 
+    atomic<int> nextVoterId;
+    
+    // Candidate ID -> its constituency. Candidates are few, so this small
+    // directory routes every vote straight to the right shard.
+    unordered_map<string, Constituency*> candidateConstituency;
+    
+    // Lock order: dataMutex, then a shard's mutex. dataMutex is held shared
+    // by everything except changes to parties, candidates, the constituency
+    // list and reloads, which take it exclusively. Voters are added under
+    // their shard's exclusive lock, so a registration only blocks votes in
+    // its own constituency; registrationMutex serializes registrations so
+    // usernames, IDs and CNICs stay unique across shards.
+    mutable shared_mutex dataMutex;
+    mutex registrationMutex;
+    
+    // Live national party ranking, updated on every vote (items = vector positions)
+    Leaderboard partyBoard;
+    
+    // Segment files of every table as of the last save (or load); a save
+    // keeps the files of segments without changes
+    DataManifest savedTables;
+    
+    // Background saves (--save-interval). saveMutex makes saves take
+    // turns; it is taken before dataMutex.
+    mutex saveMutex;
+    bool rewriteAllSegments = false;       // The last save failed (under saveMutex)
+    thread saveWorker;
+    thread metricsWorker;                  // Rewrites metrics.prom (--metrics-interval)
+    mutex workerMutex;                     // Both workers sleep on workerWakeup
+    condition_variable workerWakeup;
+    bool workersStopping = false;
+    atomic<uint64_t> savedThrough{0};      // Journal records contained in the data files
+    atomic<long long> backgroundSaves{0};
+    atomic<long long> lastSaveMicros{0};
+    
+    // Background cross-check of the saved ID counters (--verify-ids)
+    enum IdCheck { ID_CHECK_OFF, ID_CHECK_RUNNING, ID_CHECK_CONSISTENT, ID_CHECK_CORRECTED };
+    thread idVerifier;
+    atomic<int> idCheckState{ID_CHECK_OFF};
+    
+    // Every voter and candidate CNIC; most lookups of a new CNIC end here.
+    // Rebuilt only while dataMutex is held exclusively.
+    CnicFilter cnicFilter;
+    
+    // Instrumentation, shown under System Metrics and written to metrics.prom
+    MetricsRegistry metrics;
+    LatencyHistogram& loginLatency = metrics.histogram("dvs_login_seconds", "Time to check a login");
+    LatencyHistogram& voteLatency = metrics.histogram("dvs_cast_vote_seconds", "Time to cast a vote");
+    LatencyHistogram& registrationLatency = metrics.histogram("dvs_register_voter_seconds", 
+                                                              "Time to register a voter");
+    LatencyHistogram& cnicCheckLatency = metrics.histogram("dvs_cnic_exists_seconds", 
+                                                           "Time to check whether a CNIC is registered");
+    LatencyHistogram& saveLatency = metrics.histogram("dvs_save_data_seconds", "Time to save the data files");
+    LatencyHistogram& loadLatency = metrics.histogram("dvs_load_data_seconds", 
+                                                      "Time to load the data files and replay the journal");
+    LatencyHistogram& reportLatency = metrics.histogram("dvs_election_report_seconds", 
+                                                        "Time to generate the election report");
+    MetricCounter& failedLogins = metrics.counter("dvs_failed_logins_total", "Logins with a wrong username or password");
+    MetricCounter& acceptedVotes = metrics.counter("dvs_votes_cast_total", "Votes counted");
+    MetricCounter& rejectedVotes = metrics.counter("dvs_votes_rejected_total", "Votes refused (any reason)");
+    MetricCounter& registeredAccounts = metrics.counter("dvs_voters_registered_total", "Voters registered");
+    MetricCounter& rejectedRegistrations = metrics.counter("dvs_registrations_rejected_total", 
+                                                           "Registrations refused (invalid or duplicate fields)");
+    MetricCounter& failedSaves = metrics.counter("dvs_failed_saves_total", "Saves that could not write the data files");
+    MetricGauge& rollSize = metrics.gauge("dvs_registered_voters", "Voters on the roll");
+    MetricGauge& journalBacklog = metrics.gauge("dvs_journal_queued_records", "Journal records waiting for the disk");
+    MetricGauge& residentMemory = metrics.gauge("dvs_resident_memory_bytes", "Resident memory of the process");
+    MetricGauge& uptime = metrics.gauge("dvs_uptime_seconds", "Seconds since the system started");
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+    string generateCandidateId() {
+        return to_string(nextCandidateId++);
+    }
+    
+    string generatePartyId() {
+        return to_string(nextPartyId++);
+    }
+    
+    string generateVoterId() {
+        return to_string(nextVoterId++);
+    }
+    
+    // Make sure 'counter' never hands out 'id' again (IDs that are not
+    // numbers cannot collide with it)
+    static void raiseCounter(atomic<int>& counter, const string& id) {
+        int next = 0;
+        if (!parseNumber(id, next) || next == numeric_limits<int>::max()) return;
+        next++;
+        int current = counter.load();
+        while (current < next && !counter.compare_exchange_weak(current, next)) {}
+    }
+    
+    string dataPath(const string& filename) const {
+        return dataFilePath(options.dataDirectory, filename);
+    }
+    
+    // Constituency by code; "" means the first one (caller holds dataMutex)
+    Constituency* findConstituency(const string& code) {
+        if (code.empty()) {
+            return constituencies.empty() ? nullptr : constituencies.front().get();
+        }
+        for (auto& shard : constituencies) {
+            if (shard->code == code) return shard.get();
+        }
+        return nullptr;
+    }
+    
+    // Candidate by ID through the directory, optionally returning its
+    // constituency (caller holds dataMutex)
+    Candidate* findCandidate(const string& candidateId, Constituency** shardOut = nullptr) {
+        auto it = candidateConstituency.find(candidateId);
+        if (it == candidateConstituency.end()) return nullptr;
+        if (shardOut != nullptr) *shardOut = it->second;
+        return it->second->candidates.findItem("id", candidateId);
+    }
+    
+    // Lazy mode: bring the voter whose 'indexName' key matches into memory
+    // if it is still only in the shard's voter files. Returns true if the
+    // voter is in memory afterwards. Caller holds dataMutex, not the shard.
+    bool pageInVoter(Constituency& shard, const string& indexName, const string& key) {
+        uint64_t location = VoterDiskIndex::npos;
+        {
+            shared_lock<shared_mutex> lock(shard.shardMutex);
+            if (shard.voters.containsKey(indexName, key)) return true;
+            if (!shard.votersOnDisk || shard.findOnDisk(indexName, key, location) == nullptr) {
+                return false;
+            }
+        }
+        unique_lock<shared_mutex> lock(shard.shardMutex);
+        if (shard.voters.containsKey(indexName, key)) return true; // Paged in meanwhile
+        const VoterDiskIndex* file = shard.votersOnDisk ? shard.findOnDisk(indexName, key, location) : nullptr;
+        if (file == nullptr) return false;
+        file->pageIn(location, shard.voters);
+        return true;
+    }
+    
+    // Lazy mode: read the rest of every voter roll before an operation
+    // that needs the whole roll (reports, listings, saving). Voters paged
+    // in or registered since startup are newer than the file and win.
+    // Caller holds dataMutex.
+    void loadAllVoters() {
+        for (auto& shard : constituencies) {
+            if (!shard->votersOnDisk.load(memory_order_acquire)) continue;
+            unique_lock<shared_mutex> lock(shard->shardMutex);
+            if (!shard->votersOnDisk) continue;
+            VoterStore roll(&shard->candidates);
+            loadTable(roll, constituencyTable("voters", shard->code));
+            for (uint32_t p = 0; p < shard->voters.size(); p++) {
+                VoterView voter = shard->voters[p];
+                uint32_t q = roll.find("id", voter.getId());
+                if (q == VoterStore::npos) {
+                    roll.addData(voter.toVoter());
+                } else if (voter.getHasVoted()) {
+                    roll.claimVote(q, shard->voters.getVotedCandidate(p));
+                }
+            }
+            shard->voters = move(roll);
+            shard->voterFiles.clear(); // Unmaps the segment files
+            shard->votersOnDisk = false;
+        }
+    }
+    
+    // Constituency of the voter whose 'indexName' key matches, or nullptr.
+    // Every shard is searched under its own shared lock unless the caller
+    // already holds all of them. Caller holds dataMutex.
+    Constituency* findVoterConstituency(const string& indexName, const string& key, bool shardsLocked = false) {
+        for (auto& shard : constituencies) {
+            if (shardsLocked) {
+                if (shard->voters.containsKey(indexName, key)) return shard.get();
+            } else if (shard->votersOnDisk.load(memory_order_acquire)) {
+                if (pageInVoter(*shard, indexName, key)) return shard.get();
+            } else {
+                shared_lock<shared_mutex> lock(shard->shardMutex);
+                if (shard->voters.containsKey(indexName, key)) return shard.get();
+            }
+        }
+        return nullptr;
+    }
+    
+    // Apply one vote: claim the voter (atomic has-voted bit), log it,
+    // then bump the candidate and party tallies. Returns false when the
+    // voter has already voted. Caller holds dataMutex and the shard's
+    // mutex (shared is enough for both).
+    bool applyVote(Constituency& shard, uint32_t voter, Candidate* candidate, bool writeJournal) {
+        int candidatePosition = (int)(candidate - shard.candidates.getAllData().data());
+        if (!shard.voters.claimVote(voter, candidatePosition)) {
+            return false;
+        }
+        if (writeJournal) {
+            journal.append('V', shard.voters.getId(voter) + "," + candidate->getId());
+        }
+        candidate->addVote();
+        shard.candidates.markDirty(candidatePosition);
+        shard.candidateBoard.increment(candidatePosition);
+        
+        // Update party votes if candidate belongs to a party
+        if (!candidate->getIsIndependent()) {
+            Party* party = parties.findItem("id", candidate->getPartyId());
+            if (party != nullptr) {
+                int partyPosition = (int)(party - parties.getAllData().data());
+                party->addVote();
+                parties.markDirty(partyPosition);
+                partyBoard.increment(partyPosition);
+            }
+        }
+        return true;
+    }
+    
+    // Rebuild all rankings from the current tallies
+    void rebuildLeaderboards() {
+        TraceSpan span("rebuildLeaderboards");
+        vector<int> counts;
+        for (auto& shard : constituencies) {
+            counts.clear();
+            for (const auto& candidate : shard->candidates.getAllData()) counts.push_back(candidate.getVotes());
+            shard->candidateBoard.rebuild(counts);
+        }
+        counts.clear();
+        for (const auto& party : parties.getAllData()) counts.push_back(party.getTotalVotes());
+        partyBoard.rebuild(counts);
+    }
+    
+    // Record inserts without journaling (used by the public add...Record
+    // methods and by journal replay). Duplicates are refused.
+    // Parties, candidates and constituencies need dataMutex exclusively.
+    bool insertConstituency(const string& code, const string& name) {
+        if (!Constituency::isValidCode(code) || findConstituency(code) != nullptr) return false;
+        constituencies.push_back(unique_ptr<Constituency>(new Constituency(code, name)));
+        return true;
+    }
+    
+    bool insertParty(const Party& party) {
+        if (parties.containsKey("id", party.getId())) return false;
+        parties.addData(party);
+        raiseCounter(nextPartyId, party.getId());
+        if (party.getTotalVotes() == 0) {
+            partyBoard.addItem();
+        } else {
+            rebuildLeaderboards();
+        }
+        return true;
+    }
+    
+    bool insertCandidate(Constituency& shard, const Candidate& candidate) {
+        if (candidateConstituency.count(candidate.getId()) > 0 || cnicInUse(candidate.getCnic())) {
+            return false;
+        }
+        Party* party = nullptr;
+        if (!candidate.getIsIndependent()) {
+            party = parties.findItem("id", candidate.getPartyId());
+            if (party == nullptr) return false;
+        }
+        shard.candidates.addData(candidate);
+        candidateConstituency[candidate.getId()] = &shard;
+        raiseCounter(nextCandidateId, candidate.getId());
+        cnicFilter.add(candidate.getCnic());
+        if (cnicFilter.needsGrow()) rebuildCnicFilter();
+        if (party != nullptr) {
+            party->addCandidate(candidate.getId()); // Add candidate to party's candidate list
+            parties.markDirty(party - parties.getAllData().data());
+        }
+        if (candidate.getVotes() == 0) {
+            shard.candidateBoard.addItem();
+        } else {
+            rebuildLeaderboards();
+        }
+        return true;
+    }
+    
+    // Caller holds dataMutex and either registrationMutex or dataMutex exclusively
+    bool insertVoter(Constituency& shard, const Voter& voter) {
+        if (findVoterConstituency("id", voter.getId()) != nullptr || 
+            findVoterConstituency("username", voter.getUsername()) != nullptr || cnicInUse(voter.getCnic())) {
+            return false;
+        }
+        unique_lock<shared_mutex> lock(shard.shardMutex);
+        shard.voters.addData(voter);
+        raiseCounter(nextVoterId, voter.getId());
+        cnicFilter.add(voter.getCnic());
+        return true;
+    }
+    
+    // Username hash index of the voter's shard instead of scanning every
+    // voter; copies the voter into 'voter' (caller holds dataMutex)
+    bool findVoterByCredentials(const string& username, const string& password, Voter* voter = nullptr) {
+        Constituency* shard = findVoterConstituency("username", username);
+        if (shard == nullptr) return false;
+        shared_lock<shared_mutex> lock(shard->shardMutex);
+        uint32_t position = shard->voters.find("username", username);
+        if (position == VoterStore::npos || !shard->voters[position].authenticate(username, password)) {
+            return false;
+        }
+        if (voter != nullptr) *voter = shard->voters[position].toVoter();
+        return true;
+    }
+    
+    // The Bloom filter answers most "not in use" cases; a "maybe" is
+    // checked against every constituency's CNIC hash indexes
+    bool cnicInUse(const string& cnic) {
+        if (!cnicFilter.mightContain(cnic)) {
+            cnicFilter.recordLookup(false, false);
+            return false;
+        }
+        bool found = false;
+        for (auto& shard : constituencies) {
+            if (shard->votersOnDisk.load(memory_order_acquire) && pageInVoter(*shard, "cnic", cnic)) {
+                found = true;
+                break;
+            }
+            shared_lock<shared_mutex> lock(shard->shardMutex);
+            if (shard->voters.containsKey("cnic", cnic) || shard->candidates.containsKey("cnic", cnic)) {
+                found = true;
+                break;
+            }
+        }
+        cnicFilter.recordLookup(true, found);
+        return found;
+    }
+    
+    // Size the filter from the current roll and re-add every CNIC
+    // (caller holds dataMutex exclusively)
+    void rebuildCnicFilter() {
+        loadAllVoters();
+        size_t keys = 0;
+        for (const auto& shard : constituencies) {
+            keys += shard->voters.size() + shard->candidates.getAllData().size();
+        }
+        cnicFilter.reset(keys);
+        for (auto& shard : constituencies) {
+            for (uint32_t p = 0; p < shard->voters.size(); p++) cnicFilter.add(shard->voters.getCnic(p));
+            for (const auto& candidate : shard->candidates.getAllData()) cnicFilter.add(candidate.getCnic());
+        }
+    }
+    
+    // True if 'filename' exists and was written after every data table
+    // (files derived from the tables are only trusted then)
+    bool writtenAfterTables(const string& filename) const {
+        error_code error;
+        auto savedAt = filesystem::last_write_time(filename, error);
+        if (error) return false;
+        auto manifestAt = filesystem::last_write_time(dataPath("tables.manifest"), error);
+        if (!error && manifestAt > savedAt) return false;
+        vector<string> tables = {"parties"};
+        for (const auto& shard : constituencies) {
+            tables.push_back(constituencyTable("voters", shard->code));
+            tables.push_back(constituencyTable("candidates", shard->code));
+        }
+        for (const string& table : tables) {
+            for (const char* extension : {".txt", ".bin"}) {
+                auto writtenAt = filesystem::last_write_time(dataPath(table + extension), error);
+                if (!error && writtenAt > savedAt) return false;
+            }
+        }
+        return true;
+    }
+    
+    // Use the saved filter if it is current and holds as many CNICs as
+    // were loaded; otherwise build it from the records
+    void loadCnicFilter() {
+        TraceSpan span("loadCnicFilter");
+        string filterFile = dataPath("cnic.bloom");
+        size_t keys = 0;
+        for (const auto& shard : constituencies) {
+            // Nothing is paged in yet, so a lazy shard's roll is its file
+            keys += (shard->votersOnDisk ? shard->votersOnDiskCount() : shard->voters.size()) + 
+                    shard->candidates.getAllData().size();
+        }
+        if (!writtenAfterTables(filterFile) || !cnicFilter.loadFromFile(filterFile, keys)) {
+            rebuildCnicFilter();
+        }
+    }
+    
+    // Split a "code,record" journal payload; returns the shard (nullptr if unknown)
+    Constituency* splitShardPayload(const string& payload, string& record) {
+        size_t comma = payload.find(',');
+        if (comma == string::npos) return nullptr;
+        record = payload.substr(comma + 1);
+        return findConstituency(payload.substr(0, comma));
+    }
+    
+    // Re-apply journal records written after the last snapshot.
+    // Every record is idempotent, so records already contained in the
+    // snapshot (e.g. crash between saving and resetting) are skipped.
+    void replayJournal() {
+        TraceSpan span("replayJournal");
+        for (const auto& record : journal.readRecords()) {
+            const string& payload = record.second;
+            try {
+                switch (record.first) {
+                    case 'V': { // Vote: voterId,candidateId
+                        size_t comma = payload.find(',');
+                        Constituency* shard = nullptr;
+                        Candidate* candidate = findCandidate(payload.substr(comma + 1), &shard);
+                        if (candidate == nullptr) break;
+                        pageInVoter(*shard, "id", payload.substr(0, comma));
+                        uint32_t voter = shard->voters.find("id", payload.substr(0, comma));
+                        if (voter != VoterStore::npos) {
+                            applyVote(*shard, voter, candidate, false); // No-op if already voted
+                        }
+                        break;
+                    }
+                    case 'R': { // Voter registration: constituency,record
+                        string text;
+                        Constituency* shard = splitShardPayload(payload, text);
+                        if (shard == nullptr) break;
+                        Voter voter;
+                        voter.fromString(text);
+                        insertVoter(*shard, voter);
+                        break;
+                    }
+                    case 'C': { // Candidate registration: constituency,record
+                        string text;
+                        Constituency* shard = splitShardPayload(payload, text);
+                        if (shard == nullptr) break;
+                        Candidate candidate;
+                        if (!candidate.fromString(text)) break;
+                        insertCandidate(*shard, candidate);
+                        break;
+                    }
+                    case 'P': { // Party registration
+                        Party party;
+                        if (!party.fromString(payload)) break;
+                        insertParty(party);
+                        break;
+                    }
+                    case 'N': { // New constituency: code,name
+                        size_t comma = payload.find(',');
+                        insertConstituency(payload.substr(0, comma), payload.substr(comma + 1));
+                        break;
+                    }
+                    case 'T': { // Election timing: start,end
+                        size_t comma = payload.find(',');
+                        timer.setTiming(stoll(payload.substr(0, comma)), stoll(payload.substr(comma + 1)));
+                        break;
+                    }
+                }
+            } catch (const exception&) {
+                // Skip records that cannot be parsed
+            }
+        }
+    }
+    
+    // Next IDs derived from the stored records - one pass over every
+    // ID (caller holds dataMutex). Voters that are still on disk (lazy
+    // mode) are covered by their segment indexes, without loading them.
+    IdAllocatorState scanIdCounters() {
+        IdAllocatorState state;
+        for (const auto& shard : constituencies) {
+            // Find max existing candidate ID
+            for (const auto& candidate : shard->candidates.getAllData()) {
+                int id = 0;
+                if (parseNumber(candidate.getId(), id)) state.nextCandidateId = max(state.nextCandidateId, id + 1);
+            }
+            
+            // Find max existing voter ID (stored as a number - nothing to parse)
+            shared_lock<shared_mutex> shardLock(shard->shardMutex);
+            uint64_t maxVoterId = shard->voters.maxId();
+            if (shard->votersOnDisk) {
+                for (const auto& file : shard->voterFiles) maxVoterId = max(maxVoterId, file->maxNumericId());
+            }
+            state.nextVoterId = max(state.nextVoterId, (int)maxVoterId + 1);
+        }
+        
+        // Find max existing party ID
+        for (const auto& party : parties.getAllData()) {
+            int id = 0;
+            if (parseNumber(party.getId(), id)) state.nextPartyId = max(state.nextPartyId, id + 1);
+        }
+        return state;
+    }
+    
+    // Read the counters from the saved header; scan the records only
+    // when there is no current header (first run, or tables written by
+    // another tool since the last save)
+    void initializeIdCounters() {
+        TraceSpan span("initializeIdCounters");
+        IdAllocatorState state;
+        string stateFile = dataPath("ids.state");
+        if (!writtenAfterTables(stateFile) || !state.loadFromFile(stateFile)) {
+            state = scanIdCounters();
+        }
+        nextCandidateId = state.nextCandidateId;
+        nextPartyId = state.nextPartyId;
+        nextVoterId = state.nextVoterId;
+    }
+    
+    // --verify-ids: compare the counters with the records without
+    // holding up startup; counters that are behind are raised
+    void verifyIdCounters() {
+        shared_lock<shared_mutex> lock(dataMutex);
+        IdAllocatorState scanned = scanIdCounters();
+        bool behind = nextCandidateId < scanned.nextCandidateId || nextPartyId < scanned.nextPartyId ||
+                      nextVoterId < scanned.nextVoterId;
+        raiseCounter(nextCandidateId, to_string(scanned.nextCandidateId - 1));
+        raiseCounter(nextPartyId, to_string(scanned.nextPartyId - 1));
+        raiseCounter(nextVoterId, to_string(scanned.nextVoterId - 1));
+        idCheckState = behind ? ID_CHECK_CORRECTED : ID_CHECK_CONSISTENT;
+    }
+    
+    /*
+     * ===================================================================
+     * NON-INTERACTIVE OPERATIONS
+     * Thread-safe building blocks used by the menus and by batch tools
+     * ===================================================================
+     */
+
+public:
+    // Cast a vote by IDs. Many threads may call this at the same time:
+    // the candidate routes the vote to its constituency, only that shard
+    // is locked (shared) and the voter is claimed atomically, so a voter
+    // can never be counted twice.
+    VoteResult submitVote(const string& voterId, const string& candidateId) {
+        LatencyTimer timing(voteLatency);
+        VoteResult result = castVoteById(voterId, candidateId);
+        (result == VoteResult::SUCCESS ? acceptedVotes : rejectedVotes).add();
+        return result;
+    }
+
+protected:
+    VoteResult castVoteById(const string& voterId, const string& candidateId) {
+        if (!timer.isElectionActive()) return VoteResult::ELECTION_CLOSED;
+        
+        shared_lock<shared_mutex> lock(dataMutex);
+        Constituency* shard = nullptr;
+        Candidate* candidate = findCandidate(candidateId, &shard);
+        if (candidate == nullptr) {
+            return findVoterConstituency("id", voterId) != nullptr ? VoteResult::UNKNOWN_CANDIDATE 
+                                                                   : VoteResult::UNKNOWN_VOTER;
+        }
+        if (shard->votersOnDisk.load(memory_order_acquire)) pageInVoter(*shard, "id", voterId);
+        {
+            shared_lock<shared_mutex> shardLock(shard->shardMutex);
+            uint32_t voter = shard->voters.find("id", voterId);
+            if (voter != VoterStore::npos) {
+                return applyVote(*shard, voter, candidate, true) ? VoteResult::SUCCESS : VoteResult::ALREADY_VOTED;
+            }
+        }
+        // Only failed votes search the other constituencies
+        return findVoterConstituency("id", voterId) != nullptr ? VoteResult::WRONG_CONSTITUENCY 
+                                                               : VoteResult::UNKNOWN_VOTER;
+    }
+
+public:
+    
+    // Bulk ballot ingestion for polling-station result files. Each line is
+    // "voterId,candidateId". Ballots are checked against the election
+    // window, the voter's has-voted flag and the candidate list, then
+    // applied in parallel batches. Only the first ballot of a voter in the
+    // file can count, so the final tallies are identical to applying the
+    // ballots one by one through castVote. A ballot for a candidate of
+    // another constituency is rejected. Rejected ballots are written to
+    // 'rejectsFile' as "line,voterId,candidateId,reason".
+    BallotImportSummary ingestBallots(const string& ballotFile, const string& rejectsFile, 
+                                      unsigned threadCount = 0) {
+        BallotImportSummary summary;
+        auto start = chrono::steady_clock::now();
+        
+        string buffer;
+        if (!readWholeFile(ballotFile, buffer)) return summary;
+        
+        // Parse every line into (voterId, candidateId) views of the buffer
+        struct Ballot {
+            size_t line;
+            string_view voterId, candidateId;
+        };
+        vector<Ballot> ballots;
+        vector<string> rejectReasons; // Empty = accepted (index matches 'ballots')
+        {
+            string_view text(buffer);
+            size_t lineNumber = 0, pos = 0;
+            while (pos < text.size()) {
+                size_t newline = text.find('\n', pos);
+                if (newline == string_view::npos) newline = text.size();
+                string_view line = text.substr(pos, newline - pos);
+                if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                lineNumber++;
+                pos = newline + 1;
+                if (line.empty()) continue;
+                
+                FieldTokenizer fields(line);
+                Ballot ballot = {lineNumber, fields.next(), fields.next()};
+                ballots.push_back(ballot);
+                rejectReasons.push_back(ballot.voterId.empty() || ballot.candidateId.empty() || fields.hasMore() 
+                                        ? "Malformed line" : "");
+            }
+        }
+        summary.total = ballots.size();
+        
+        if (!timer.isElectionActive()) {
+            for (auto& reason : rejectReasons) {
+                if (reason.empty()) reason = voteResultText(VoteResult::ELECTION_CLOSED);
+            }
+        } else {
+            const size_t batchSize = 65536;
+            size_t batchCount = (ballots.size() + batchSize - 1) / batchSize;
+            vector<uint32_t> ballotVoter(ballots.size(), VoterStore::npos);
+            vector<Candidate*> ballotCandidate(ballots.size(), nullptr);
+            vector<Constituency*> ballotShard(ballots.size(), nullptr);
+            
+            // Run 'task(first, end)' over all batches on a pool of threads
+            auto runBatches = [&](const function<void(size_t, size_t)>& task) {
+                runParallel(batchCount, threadCount, [&](size_t b) {
+                    task(b * batchSize, min(ballots.size(), (b + 1) * batchSize));
+                });
+            };
+            
+            // The whole import sees a stable voter roll in every constituency
+            shared_lock<shared_mutex> lock(dataMutex);
+            loadAllVoters();
+            vector<shared_lock<shared_mutex>> shardLocks;
+            for (auto& shard : constituencies) {
+                shardLocks.emplace_back(shard->shardMutex);
+            }
+            
+            // Pass 1 (parallel): resolve candidate, constituency and voter of every ballot
+            runBatches([&](size_t first, size_t end) {
+                for (size_t i = first; i < end; i++) {
+                    if (!rejectReasons[i].empty()) continue;
+                    string voterId(ballots[i].voterId);
+                    ballotCandidate[i] = findCandidate(string(ballots[i].candidateId), &ballotShard[i]);
+                    if (ballotCandidate[i] != nullptr) {
+                        ballotVoter[i] = ballotShard[i]->voters.find("id", voterId);
+                    }
+                    if (ballotVoter[i] != VoterStore::npos) continue;
+                    
+                    bool voterKnown = findVoterConstituency("id", voterId, true) != nullptr;
+                    if (!voterKnown) {
+                        rejectReasons[i] = voteResultText(VoteResult::UNKNOWN_VOTER);
+                    } else if (ballotCandidate[i] == nullptr) {
+                        rejectReasons[i] = voteResultText(VoteResult::UNKNOWN_CANDIDATE);
+                    } else {
+                        rejectReasons[i] = voteResultText(VoteResult::WRONG_CONSTITUENCY);
+                    }
+                }
+            });
+            
+            // Pass 2 (sequential): only a voter's first valid ballot can count,
+            // exactly as when the ballots are cast one by one. A voter is one
+            // record: (constituency number, position in its store).
+            unordered_map<const Constituency*, uint64_t> shardNumber;
+            for (size_t k = 0; k < constituencies.size(); k++) shardNumber[constituencies[k].get()] = k;
+            unordered_map<uint64_t, size_t> firstBallot;
+            firstBallot.reserve(ballots.size());
+            for (size_t i = 0; i < ballots.size(); i++) {
+                if (rejectReasons[i].empty() && 
+                    !firstBallot.emplace(shardNumber[ballotShard[i]] << 32 | ballotVoter[i], i).second) {
+                    rejectReasons[i] = "Duplicate ballot in file";
+                }
+            }
+            
+            // Pass 3 (parallel): claim voters and count votes; each batch
+            // writes its accepted votes to the journal with a single append
+            runBatches([&](size_t first, size_t end) {
+                vector<string> journalRecords;
+                for (size_t i = first; i < end; i++) {
+                    if (!rejectReasons[i].empty()) continue;
+                    if (applyVote(*ballotShard[i], ballotVoter[i], ballotCandidate[i], false)) {
+                        journalRecords.push_back(ballotShard[i]->voters.getId(ballotVoter[i]) + "," + 
+                                                 ballotCandidate[i]->getId());
+                    } else {
+                        rejectReasons[i] = voteResultText(VoteResult::ALREADY_VOTED);
+                    }
+                }
+                journal.appendBatch('V', journalRecords);
+            });
+        }
+        
+        // Rejects file, in input order
+        ofstream rejects(rejectsFile);
+        string out;
+        for (size_t i = 0; i < ballots.size(); i++) {
+            if (rejectReasons[i].empty()) {
+                summary.accepted++;
+                continue;
+            }
+            summary.rejected++;
+            out += to_string(ballots[i].line) + ",";
+            out.append(ballots[i].voterId);
+            out += ",";
+            out.append(ballots[i].candidateId);
+            out += "," + rejectReasons[i] + "\n";
+        }
+        rejects << out;
+        acceptedVotes.add(summary.accepted);
+        rejectedVotes.add(summary.rejected);
+        
+        summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return summary;
+    }
+    
+    // Add records (journaled). Return false for duplicates, an unknown
+    // constituency or, for a party candidate, an unknown party. An empty
+    // constituency code means the first constituency.
+    bool addConstituencyRecord(const string& code, const string& name) {
+        unique_lock<shared_mutex> lock(dataMutex);
+        if (!insertConstituency(code, name)) return false;
+        journal.append('N', code + "," + name);
+        return true;
+    }
+    
+    bool addPartyRecord(const Party& party) {
+        unique_lock<shared_mutex> lock(dataMutex);
+        if (!insertParty(party)) return false;
+        journal.append('P', party.toString());
+        return true;
+    }
+    
+    bool addCandidateRecord(const Candidate& candidate, const string& constituencyCode = "") {
+        unique_lock<shared_mutex> lock(dataMutex);
+        Constituency* shard = findConstituency(constituencyCode);
+        if (shard == nullptr || !insertCandidate(*shard, candidate)) return false;
+        journal.append('C', shard->code + "," + candidate.toString());
+        return true;
+    }
+    
+    // Only the voter's own constituency is locked exclusively
+    bool addVoterRecord(const Voter& voter, const string& constituencyCode = "") {
+        lock_guard<mutex> registration(registrationMutex);
+        return insertVoterRecord(voter, constituencyCode);
+    }
+    
+    // addVoterRecord() for a caller that already holds registrationMutex
+    bool insertVoterRecord(const Voter& voter, const string& constituencyCode) {
+        shared_lock<shared_mutex> lock(dataMutex);
+        Constituency* shard = findConstituency(constituencyCode);
+        if (shard == nullptr || !insertVoter(*shard, voter)) return false;
+        journal.append('R', shard->code + "," + voter.toString());
+        
+        // registrationMutex is always taken before dataMutex, so it can stay held
+        if (cnicFilter.needsGrow()) {
+            lock.unlock();
+            unique_lock<shared_mutex> exclusive(dataMutex);
+            if (cnicFilter.needsGrow()) rebuildCnicFilter();
+        }
+        return true;
+    }
+    
+    // Register a voter with a freshly generated ID (returned in 'voterId')
+    EngineStatus registerVoterAccount(const string& username, const string& password, const string& name, 
+                                      const string& cnic, const string& constituencyCode = "", 
+                                      string* voterId = nullptr) {
+        LatencyTimer timing(registrationLatency);
+        EngineStatus status = createVoterAccount(username, password, name, cnic, constituencyCode, voterId);
+        (status == EngineStatus::OK ? registeredAccounts : rejectedRegistrations).add();
+        return status;
+    }
+    
+protected:
+    EngineStatus createVoterAccount(const string& username, const string& password, const string& name, 
+                                    const string& cnic, const string& constituencyCode, string* voterId) {
+        if (!isValidField(username) || !isValidField(password) || !isValidField(name)) {
+            return EngineStatus::INVALID_FIELD;
+        }
+        if (!isValidCnicFormat(cnic)) return EngineStatus::INVALID_CNIC;
+        // Registrations take turns, so the username and CNIC are still free
+        // when the voter is added and a rejected registration uses no ID
+        lock_guard<mutex> registration(registrationMutex);
+        {
+            shared_lock<shared_mutex> lock(dataMutex);
+            if (findConstituency(constituencyCode) == nullptr) return EngineStatus::UNKNOWN_CONSTITUENCY;
+            if (findVoterConstituency("username", username) != nullptr) return EngineStatus::DUPLICATE_USERNAME;
+            if (cnicInUse(cnic)) return EngineStatus::DUPLICATE_CNIC;
+        }
+        string id = generateVoterId();
+        if (!insertVoterRecord(Voter(username, password, name, id, cnic), constituencyCode)) {
+            return EngineStatus::DUPLICATE_CNIC; // A candidate registered the CNIC meanwhile
+        }
+        if (voterId != nullptr) *voterId = id;
+        return EngineStatus::OK;
+    }
+
+public:
+    EngineStatus setElectionWindow(time_t start, time_t end) {
+        if (end <= start) return EngineStatus::INVALID_WINDOW;
+        shared_lock<shared_mutex> lock(dataMutex); // A save captures both or neither
+        journal.append('T', to_string(start) + "," + to_string(end));
+        timer.setTiming(start, end);
+        return EngineStatus::OK;
+    }
+    
+    // Check credentials without any console I/O; a voter is copied into
+    // 'voter' (voters are stored as columns), which the caller owns
+    User* authenticate(const string& username, const string& password, Voter& voter) {
+        LatencyTimer timing(loginLatency);
+        if (admin.authenticate(username, password)) {
+            return &admin;
+        }
+        shared_lock<shared_mutex> lock(dataMutex);
+        if (findVoterByCredentials(username, password, &voter)) {
+            return &voter; // Polymorphism - Voter* as User*
+        }
+        failedLogins.add();
+        return nullptr;
+    }
+    
+    // Voter login for concurrent sessions: returns the voter ID ("" if the
+    // credentials are wrong) instead of a pointer that a registration in
+    // another session could invalidate
+    string loginVoter(const string& username, const string& password) {
+        LatencyTimer timing(loginLatency);
+        shared_lock<shared_mutex> lock(dataMutex);
+        Voter voter;
+        if (findVoterByCredentials(username, password, &voter)) return voter.getId();
+        failedLogins.add();
+        return "";
+    }
+    
+    // Current tallies by ID (-1 if unknown)
+    int getCandidateVotes(const string& candidateId) {
+        shared_lock<shared_mutex> lock(dataMutex);
+        const Candidate* candidate = findCandidate(candidateId);
+        return candidate != nullptr ? candidate->getVotes() : -1;
+    }
+    
+    int getPartyVotes(const string& partyId) {
+        shared_lock<shared_mutex> lock(dataMutex);
+        const Party* party = parties.findItem("id", partyId);
+        return party != nullptr ? party->getTotalVotes() : -1;
+    }
+
+    void warn(const string& message) {
+        if (warningLog != nullptr) *warningLog << "Warning: " << message << endl;
+    }
+
+public:
+    // Constructor - loads the data files and replays the journal. The
+    // engine does no console I/O; its warnings go to 'log' if given.
+    ElectionEngine(const SystemOptions& opts = SystemOptions(), ostream* log = nullptr) 
+        : admin("admin", "admin123", "System Administrator", "ADM001", "00000-0000000-0"), 
+          journal(dataFilePath(opts.dataDirectory, "votes.journal"), opts.journalCommitWindowMs, opts.journalQueueRecords), 
+          options(opts), warningLog(log) {
+        // Hash indexes for the hot lookups (login, CNIC checks, voting);
+        // each constituency declares its own candidate and voter indexes
+        parties.addIndex("id", &Party::getId);
+        
+        loadData();
+        if (options.verifyIdCounters) {
+            idCheckState = ID_CHECK_RUNNING;
+            idVerifier = thread(&ElectionEngine::verifyIdCounters, this);
+        }
+        if (options.saveIntervalMs > 0) {
+            saveWorker = thread(&ElectionEngine::runBackgroundSaves, this);
+        }
+        if (options.metricsIntervalMs > 0) {
+            metricsWorker = thread(&ElectionEngine::runMetricsDumps, this);
+        }
+    }
+    
+    // Destructor - saves data when system shuts down
+    virtual ~ElectionEngine() {
+        TraceSpan span("shutdown");
+        {
+            lock_guard<mutex> lock(workerMutex);
+            workersStopping = true;
+        }
+        workerWakeup.notify_all();
+        if (saveWorker.joinable()) saveWorker.join();
+        if (metricsWorker.joinable()) metricsWorker.join();
+        if (idVerifier.joinable()) idVerifier.join();
+        saveData();
+        {
+            TraceSpan flushSpan("journal flush");
+            journal.flush(); // Flush barrier: nothing is left in the queue
+        }
+        saveMetrics();
+    }
+    
+    // A save: the changed segments and the small files, formatted under
+    // the exclusive lock and written to disk after it is released
+    struct PendingSave {
+        DataManifest manifest;
+        vector<pair<string, string>> files; // File name and contents
+        vector<string> voterSegments;        // Segment files that get a voter index
+        ElectionTimer timer;
+        IdAllocatorState counters;
+        string cnicFilter;
+        uint64_t journalRecords = 0;         // Journal records the save contains
+        bool formatted = true;               // False if a segment could not be formatted
+    };
+    
+    // Add one table to a save as segments in the current format. A
+    // segment without changed records keeps its file from the last save;
+    // formatSegment(first, last, contents) formats one that changed.
+    void captureSegments(const string& baseName, size_t recordCount, PendingSave& save,
+                         const function<bool(size_t, size_t)>& isRangeDirty,
+                         const function<bool(size_t, size_t, string&)>& formatSegment, bool voterTable = false) {
+        TableSegments& segments = save.manifest.tables[baseName];
+        segments.extension = options.binarySnapshots ? ".bin" : ".txt";
+        segments.recordCount = recordCount;
+        const TableSegments* saved = savedTables.find(baseName);
+        bool sameFormat = !rewriteAllSegments && saved != nullptr && saved->extension == segments.extension;
+        string basePath = dataPath(baseName);
+        for (size_t k = 0; k < segments.segmentCount(); k++) {
+            size_t first = k * SEGMENT_RECORDS, last = min(recordCount, first + SEGMENT_RECORDS);
+            if (sameFormat && k < saved->segmentCount() && !isRangeDirty(first, last)) {
+                segments.generations.push_back(saved->generations[k]);
+                continue;
+            }
+            segments.generations.push_back(save.manifest.generation);
+            string file = segments.segmentFile(basePath, k);
+            save.files.push_back(make_pair(file, string()));
+            if (!formatSegment(first, last, save.files.back().second)) save.formatted = false;
+            if (voterTable) save.voterSegments.push_back(file);
+        }
+    }
+    
+    template<typename T>
+    void captureTable(DataManager<T>& table, const string& baseName, PendingSave& save) {
+        TraceSpan span("captureTable", baseName);
+        const vector<T>& data = table.getAllData();
+        captureSegments(baseName, data.size(), save, 
+            [&](size_t first, size_t last) { return table.isRangeDirty(first, last); },
+            [&](size_t first, size_t last, string& contents) {
+                if (options.binarySnapshots) return FileHandler<T>::formatSnapshot(data, contents, first, last);
+                contents = FileHandler<T>::formatText(data, first, last);
+                return true;
+            });
+        table.markAllClean();
+    }
+    
+    // Voter segments also get the index that lazy mode reads
+    void captureTable(VoterStore& store, const string& baseName, PendingSave& save) {
+        TraceSpan span("captureTable", baseName);
+        captureSegments(baseName, store.size(), save,
+            [&](size_t first, size_t last) { return store.isRangeDirty(first, last); },
+            [&](size_t first, size_t last, string& contents) {
+                if (options.binarySnapshots) return FileHandler<Voter>::formatSnapshot(store, contents, first, last);
+                contents = FileHandler<Voter>::formatText(store, first, last);
+                return true;
+            }, true);
+        store.markAllClean();
+    }
+    
+    // Load one table from its segments, or else from a single
+    // "<baseName>.txt" / ".bin" file (older saves and --generate write
+    // those; the next save splits them into segments)
+    template<typename T>
+    void loadTable(vector<T>& data, const string& baseName) {
+        const TableSegments* segments = savedTables.find(baseName);
+        if (segments != nullptr) {
+            if (!FileHandler<T>::loadFromFiles(data, segments->segmentFiles(dataPath(baseName)), 
+                                               segments->extension == ".bin")) {
+                warn("a segment of " + baseName + " is missing.");
+            }
+            return;
+        }
+        string filename = singleTableFile(baseName);
+        if (filename.empty()) {
+            data.clear();
+        } else {
+            FileHandler<T>::loadFromFiles(data, {filename}, isSnapshotFile(filename));
+        }
+    }
+    
+    // The voter store has its own loaders (no Voter objects are built)
+    void loadTable(VoterStore& store, const string& baseName) {
+        const TableSegments* segments = savedTables.find(baseName);
+        if (segments != nullptr) {
+            vector<string> files = segments->segmentFiles(dataPath(baseName));
+            bool loaded = segments->extension == ".bin" ? store.loadFromSnapshots(files) : store.loadFromFiles(files);
+            if (!loaded) warn("a segment of " + baseName + " is missing.");
+            return;
+        }
+        string filename = singleTableFile(baseName);
+        if (filename.empty()) {
+            store.clearData();
+        } else if (isSnapshotFile(filename)) {
+            store.loadFromSnapshot(filename);
+        } else {
+            store.loadFromFile(filename);
+        }
+    }
+    
+    // Single-file copy of a table, preferring the current format ("" if none)
+    string singleTableFile(const string& baseName) const {
+        string text = dataPath(baseName + ".txt"), snapshot = dataPath(baseName + ".bin");
+        string preferred = options.binarySnapshots ? snapshot : text;
+        string other = options.binarySnapshots ? text : snapshot;
+        if (filesystem::exists(preferred)) return preferred;
+        return filesystem::exists(other) ? other : "";
+    }
+    
+    static bool isSnapshotFile(const string& filename) {
+        return filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".bin") == 0;
+    }
+    
+    // Read the manifest of the last save. A table whose single file was
+    // written after it (e.g. by --generate) is loaded from that file.
+    void loadManifest() {
+        TraceSpan span("loadManifest");
+        string manifestFile = dataPath("tables.manifest");
+        if (!savedTables.loadFromFile(manifestFile)) {
+            savedTables = DataManifest();
+            return;
+        }
+        error_code error;
+        auto savedAt = filesystem::last_write_time(manifestFile, error);
+        for (auto it = savedTables.tables.begin(); it != savedTables.tables.end();) {
+            bool replaced = false;
+            for (const char* extension : {".txt", ".bin"}) {
+                auto writtenAt = filesystem::last_write_time(dataPath(it->first + extension), error);
+                if (!error && writtenAt > savedAt) replaced = true;
+            }
+            it = replaced ? savedTables.tables.erase(it) : next(it);
+        }
+    }
+    
+    // Lazy mode: map the voter segments and their indexes instead of
+    // loading the roll; false (load normally) if an index is missing or
+    // does not match its segment
+    bool openVoterFiles(Constituency& shard, const string& baseName) {
+        const TableSegments* segments = savedTables.find(baseName);
+        if (segments == nullptr) return false;
+        vector<unique_ptr<VoterDiskIndex>> files;
+        for (const string& source : segments->segmentFiles(dataPath(baseName))) {
+            unique_ptr<VoterDiskIndex> index(new VoterDiskIndex());
+            if (!index->open(TableSegments::indexFileOf(source), source, segments->extension == ".bin")) {
+                return false;
+            }
+            files.push_back(move(index));
+        }
+        shard.voterFiles = move(files);
+        shard.votersOnDisk = true;
+        return true;
+    }
+    
+    bool tableExists(const string& baseName) const {
+        return savedTables.find(baseName) != nullptr || !singleTableFile(baseName).empty();
+    }
+    
+    // Rest of a table's file name after "<table>.": "txt", "bin" or "idx",
+    // optionally after "<k>.<generation>." and before ".tmp"
+    static bool isTableFileSuffix(string rest) {
+        if (rest.size() > 4 && rest.compare(rest.size() - 4, 4, ".tmp") == 0) rest.resize(rest.size() - 4);
+        vector<string_view> parts;
+        FieldTokenizer tokens(rest, '.');
+        while (tokens.hasMore()) parts.push_back(tokens.next());
+        if (parts.size() != 1 && parts.size() != 3) return false;
+        for (size_t i = 0; i + 1 < parts.size(); i++) {
+            if (parts[i].empty() || parts[i].find_first_not_of("0123456789") != string_view::npos) return false;
+        }
+        return parts.back() == "txt" || parts.back() == "bin" || parts.back() == "idx";
+    }
+    
+    // After a save: delete the files of saved tables that the manifest does
+    // not name - older segments, leftovers of an interrupted save and
+    // single-file copies that are now segmented
+    void removeReplacedFiles() {
+        set<string> current;
+        for (const auto& entry : savedTables.tables) {
+            for (const string& file : entry.second.segmentFiles(entry.first)) {
+                current.insert(file);
+                current.insert(TableSegments::indexFileOf(file));
+            }
+        }
+        vector<string> replaced;
+        error_code error;
+        string directory = options.dataDirectory.empty() ? "." : options.dataDirectory;
+        for (const auto& item : filesystem::directory_iterator(directory, error)) {
+            string name = item.path().filename().string();
+            size_t dot = name.find('.'); // Table names have no dots
+            if (dot == string::npos || current.count(name) > 0 || savedTables.find(name.substr(0, dot)) == nullptr) {
+                continue;
+            }
+            if (isTableFileSuffix(name.substr(dot + 1))) replaced.push_back(name);
+        }
+        for (const string& name : replaced) {
+            filesystem::remove(dataPath(name), error);
+        }
+    }
+    
+    // Take everything a save writes (caller holds dataMutex exclusively,
+    // so the data and the journal position match)
+    void captureSave(PendingSave& save) {
+        TraceSpan span("captureSave");
+        loadAllVoters();
+        save.journalRecords = journal.startNewFileAfterQueued();
+        string list;
+        for (const auto& shard : constituencies) {
+            list += shard->toString() + "\n";
+        }
+        save.files.push_back(make_pair(dataPath("constituencies.txt"), list));
+        
+        save.manifest.generation = savedTables.generation + 1;
+        for (auto& shard : constituencies) {
+            captureTable(shard->candidates, constituencyTable("candidates", shard->code), save);
+            captureTable(shard->voters, constituencyTable("voters", shard->code), save);
+        }
+        captureTable(parties, "parties", save);
+        
+        save.timer = timer;
+        save.cnicFilter = cnicFilter.serialize();
+        save.counters.nextCandidateId = nextCandidateId;
+        save.counters.nextPartyId = nextPartyId;
+        save.counters.nextVoterId = nextVoterId;
+    }
+    
+    // Write a captured save up to its manifest (no lock held)
+    bool writeSave(PendingSave& save) {
+        TraceSpan span("writeSave");
+        if (!save.formatted) return false;
+        for (auto& file : save.files) {
+            TraceSpan fileSpan("writeFile", file.first);
+            if (!writeFile(file.first, file.second)) return false;
+            string().swap(file.second); // Written - free the memory
+        }
+        for (const string& segment : save.voterSegments) {
+            TraceSpan indexSpan("VoterDiskIndex::build", segment);
+            VoterDiskIndex::build(TableSegments::indexFileOf(segment), segment, isSnapshotFile(segment));
+        }
+        return save.manifest.tables == savedTables.tables || // Otherwise nothing was written
+               save.manifest.saveToFile(dataPath("tables.manifest"));
+    }
+    
+    // Save all data, then drop the journal records the save contains.
+    // Every constituency has its own candidate and voter tables. Changed
+    // segments are formatted under the exclusive lock and written after
+    // it is released, so votes and the menu wait for the formatting but
+    // never for the disk. Only segments with changes are written (to new
+    // files), and committing the manifest switches to them, so a crash
+    // during the save leaves the last save intact.
+    bool saveData() {
+        lock_guard<mutex> saving(saveMutex);
+        LatencyTimer timing(saveLatency);
+        TraceSpan span("saveData");
+        PendingSave save;
+        {
+            unique_lock<shared_mutex> lock(dataMutex);
+            captureSave(save);
+        }
+        if (!writeSave(save)) {
+            rewriteAllSegments = true; // The captured changes are only in the journal now
+            failedSaves.add();
+            warn("the data files could not be saved; changes are kept in the journal.");
+            return false;
+        }
+        rewriteAllSegments = false;
+        if (save.manifest.tables != savedTables.tables) {
+            {
+                unique_lock<shared_mutex> lock(dataMutex); // loadAllVoters() reads it
+                savedTables = move(save.manifest);
+            }
+            removeReplacedFiles();
+        }
+        
+        save.timer.saveToFile(dataPath("election_timing.txt"));
+        writeFile(dataPath("cnic.bloom"), save.cnicFilter); // After the tables it describes
+        save.counters.saveToFile(dataPath("ids.state"));
+        journal.discardOldFile();
+        savedThrough = save.journalRecords;
+        return true;
+    }
+    
+    // Background saves: every saveIntervalMs, if anything was journaled
+    // since the last save. Shards still paged in lazily are left for the
+    // save at exit (saving reads the whole roll).
+    void runBackgroundSaves() {
+        unique_lock<mutex> lock(workerMutex);
+        while (!workerWakeup.wait_for(lock, chrono::milliseconds(options.saveIntervalMs), 
+                                      [&]() { return workersStopping; })) {
+            lock.unlock();
+            bool lazyShards = false;
+            {
+                shared_lock<shared_mutex> dataLock(dataMutex);
+                for (const auto& shard : constituencies) lazyShards = lazyShards || shard->votersOnDisk;
+            }
+            if (!lazyShards && journal.getQueuedCount() != savedThrough) {
+                auto start = chrono::steady_clock::now();
+                if (saveData()) {
+                    backgroundSaves++;
+                    lastSaveMicros = chrono::duration_cast<chrono::microseconds>(
+                        chrono::steady_clock::now() - start).count();
+                }
+            }
+            lock.lock();
+        }
+    }
+    
+    // Set the gauges that describe the current state (the others are
+    // updated as things happen)
+    void refreshGauges() {
+        int64_t voters = 0;
+        {
+            shared_lock<shared_mutex> lock(dataMutex);
+            for (const auto& shard : constituencies) {
+                shared_lock<shared_mutex> shardLock(shard->shardMutex);
+                voters += (int64_t)shard->voters.size();
+            }
+        }
+        rollSize.set(voters);
+        journalBacklog.set((int64_t)journal.getPendingRecords());
+        residentMemory.set((int64_t)residentBytes());
+        uptime.set(chrono::duration_cast<chrono::seconds>(chrono::steady_clock::now() - startTime).count());
+    }
+    
+    // Rewrite metrics.prom (Prometheus text format; replaced atomically,
+    // so a collector never reads half a file)
+    void saveMetrics() {
+        refreshGauges();
+        writeFile(dataPath("metrics.prom"), metrics.formatPrometheus());
+    }
+    
+    void runMetricsDumps() {
+        unique_lock<mutex> lock(workerMutex);
+        while (!workerWakeup.wait_for(lock, chrono::milliseconds(options.metricsIntervalMs), 
+                                      [&]() { return workersStopping; })) {
+            lock.unlock();
+            saveMetrics();
+            lock.lock();
+        }
+    }
+    
+    // Load the last snapshot from files and replay the journal on top of it
+    void loadData() {
+        LatencyTimer timing(loadLatency);
+        TraceSpan span("loadData");
+        unique_lock<shared_mutex> lock(dataMutex);
+        constituencies.clear();
+        candidateConstituency.clear();
+        loadManifest();
+        for (const auto& entry : readConstituencyList(dataPath("constituencies.txt"))) {
+            insertConstituency(entry.first, entry.second);
+        }
+        if (constituencies.empty()) {
+            insertConstituency(DEFAULT_CONSTITUENCY, "Default Constituency");
+        }
+        
+        for (size_t i = 0; i < constituencies.size(); i++) {
+            Constituency& shard = *constituencies[i];
+            string candidateTable = constituencyTable("candidates", shard.code);
+            string voterTable = constituencyTable("voters", shard.code);
+            // Data saved before constituencies existed belongs to the first one
+            if (i == 0 && !tableExists(candidateTable) && !tableExists(voterTable)) {
+                candidateTable = "candidates";
+                voterTable = "voters";
+            }
+            loadTable(shard.candidates.getAllData(), candidateTable);
+            // Files were read straight into the vector, so refresh the
+            // indexes (voters resolve their candidate through them)
+            shard.candidates.rebuildIndexes();
+            shard.candidates.markAllClean();
+            if (!options.lazyVoters || !openVoterFiles(shard, voterTable)) {
+                loadTable(shard.voters, voterTable);
+            }
+            
+            for (const auto& candidate : shard.candidates.getAllData()) {
+                candidateConstituency.emplace(candidate.getId(), &shard);
+            }
+        }
+        loadTable(parties.getAllData(), "parties");
+        timer.loadFromFile(dataPath("election_timing.txt"));
+        parties.rebuildIndexes();
+        parties.markAllClean();
+        rebuildLeaderboards();
+        loadCnicFilter();
+        initializeIdCounters(); // Before the replay, which raises them past journaled IDs
+        
+        replayJournal();
+        if (cnicFilter.needsGrow()) rebuildCnicFilter();
+    }
+    
+    /*
+     * ===================================================================
+     * TYPED ENGINE CALLS
+     * Each one validates its arguments, applies the change (journaled)
+     * and returns a status code; new IDs come back through the pointer.
+     * The console menus and the batch runner both go through these.
+     * ===================================================================
+     */
+    
+    // Stored fields are comma-separated with one record per line
+    static bool isValidField(const string& field) {
+        return !field.empty() && field.find_first_of(",\r\n") == string::npos;
+    }
+    
+    // Check if CNIC already exists in the system
+    bool cnicExists(const string& cnic) {
+        LatencyTimer timing(cnicCheckLatency);
+        shared_lock<shared_mutex> lock(dataMutex);
+        return cnicInUse(cnic);
+    }
+    
+    // Check if a voter username is already taken
+    bool usernameExists(const string& username) {
+        shared_lock<shared_mutex> lock(dataMutex);
+        return findVoterConstituency("username", username) != nullptr;
+    }
+    
+    // The candidates of the voter's own constituency (false if the voter is unknown)
+    bool getBallot(const string& voterId, vector<BallotEntry>& ballot) {
+        shared_lock<shared_mutex> lock(dataMutex);
+        Constituency* shard = findVoterConstituency("id", voterId);
+        if (shard == nullptr) return false;
+        ballot.clear();
+        for (const auto& candidate : shard->candidates.getAllData()) {
+            ballot.push_back({candidate.getId(), candidate.getName(), 
+                              candidate.getIsIndependent() ? "Independent" : candidate.getPartyId()});
+        }
+        return true;
+    }
+    
+    bool getVoterStatus(const string& voterId, VoterStatus& status) {
+        shared_lock<shared_mutex> lock(dataMutex);
+        Constituency* shard = findVoterConstituency("id", voterId);
+        if (shard == nullptr) return false;
+        shared_lock<shared_mutex> shardLock(shard->shardMutex);
+        VoterView voter = shard->voters[shard->voters.find("id", voterId)];
+        status.constituency = shard->code;
+        status.hasVoted = voter.getHasVoted();
+        status.votedFor = voter.getVotedFor();
+        return true;
+    }
+    
+    // Total over all constituencies (caller holds dataMutex)
+    int candidateCount() const {
+        int count = 0;
+        for (const auto& shard : constituencies) count += shard->candidates.getSize();
+        return count;
+    }
+    
+    // Total over all constituencies (caller holds dataMutex)
+    int voterCount() const {
+        int count = 0;
+        for (const auto& shard : constituencies) {
+            shared_lock<shared_mutex> shardLock(shard->shardMutex);
+            count += shard->voters.getSize();
+        }
+        return count;
+    }
+    
+    EngineStatus createConstituency(const string& code, const string& name) {
+        if (!Constituency::isValidCode(code)) return EngineStatus::INVALID_CODE;
+        if (!isValidField(name)) return EngineStatus::INVALID_FIELD;
+        return addConstituencyRecord(code, name) ? EngineStatus::OK : EngineStatus::DUPLICATE_CODE;
+    }
+    
+    EngineStatus createParty(const string& name, const string& symbol, const string& manifesto, 
+                             string* partyId = nullptr) {
+        if (!isValidField(name) || !isValidField(symbol) || !isValidField(manifesto)) {
+            return EngineStatus::INVALID_FIELD;
+        }
+        string id = generatePartyId();
+        addPartyRecord(Party(id, name, symbol, manifesto));
+        if (partyId != nullptr) *partyId = id;
+        return EngineStatus::OK;
+    }
+    
+    // An empty party ID adds an independent candidate
+    EngineStatus createCandidate(const string& name, const string& cnic, const string& partyId, 
+                                 const string& manifesto, const string& constituencyCode = "", 
+                                 string* candidateId = nullptr) {
+        if (!isValidField(name) || !isValidField(manifesto)) return EngineStatus::INVALID_FIELD;
+        if (!isValidCnicFormat(cnic)) return EngineStatus::INVALID_CNIC;
+        {
+            // Constituencies and parties are never removed, so this still holds below
+            shared_lock<shared_mutex> lock(dataMutex);
+            if (findConstituency(constituencyCode) == nullptr) return EngineStatus::UNKNOWN_CONSTITUENCY;
+            if (!partyId.empty() && parties.findItem("id", partyId) == nullptr) return EngineStatus::UNKNOWN_PARTY;
+        }
+        string id = generateCandidateId();
+        Candidate candidate = partyId.empty() ? Candidate(id, name, cnic, manifesto) 
+                                              : Candidate(id, name, cnic, partyId, manifesto);
+        if (!addCandidateRecord(candidate, constituencyCode)) return EngineStatus::DUPLICATE_CNIC;
+        if (candidateId != nullptr) *candidateId = id;
+        return EngineStatus::OK;
+    }
+    
+    // Tally every constituency in parallel - each thread takes whole
+    // shards and only locks the shard it is counting (caller holds dataMutex)
+    vector<ConstituencyResult> tallyConstituencies(unsigned threadCount = 0) {
+        TraceSpan span("tallyConstituencies");
+        loadAllVoters();
+        vector<ConstituencyResult> results(constituencies.size());
+        runParallel(results.size(), threadCount, [&](size_t i) {
+            Constituency& shard = *constituencies[i];
+            ConstituencyResult& result = results[i];
+            TraceSpan shardSpan("tally constituency", shard.code);
+            shared_lock<shared_mutex> shardLock(shard.shardMutex);
+            result.shard = &shard;
+            result.registered = shard.voters.getSize();
+            result.turnout = shard.voters.countVoted();
+            for (const auto& candidate : shard.candidates.getAllData()) {
+                result.totalVotes += candidate.getVotes();
+            }
+            {
+                TraceSpan rankingSpan("rank candidates", shard.code);
+                result.ranking = shard.candidateBoard.ranking();
+            }
+            if (result.totalVotes > 0) {
+                result.winners = shard.candidateBoard.leaders();
+            }
+        });
+        return results;
+    }
+    
+    // Each constituency's winner takes the seat for its party; a tie or a
+    // constituency without votes leaves the seat undecided
+    static void countSeats(const vector<ConstituencyResult>& results, ElectionTally& tally) {
+        for (const auto& result : results) {
+            tally.totalVotes += result.totalVotes;
+            string winner;
+            if (result.winners.size() == 1) {
+                const Candidate& candidate = result.shard->candidates.getAllData()[result.winners[0]];
+                tally.seats[candidate.getIsIndependent() ? "Independent" : candidate.getPartyId()]++;
+                winner = candidate.getId();
+            } else {
+                tally.undecidedSeats++;
+            }
+            tally.winners.push_back(make_pair(result.shard->code, winner));
+        }
+    }
+    
+    // Final result; only once the election has ended
+    EngineStatus tally(ElectionTally& outcome) {
+        if (!timer.hasElectionEnded()) return EngineStatus::ELECTION_NOT_ENDED;
+        journal.flush(); // Flush barrier: every counted vote is on the disk
+        shared_lock<shared_mutex> lock(dataMutex);
+        outcome = ElectionTally();
+        countSeats(tallyConstituencies(), outcome);
+        return EngineStatus::OK;
+    }
+    
+    // The totals of a final report: seats, counts and the largest party
+    // (caller holds dataMutex)
+    ReportTotals reportTotals(const vector<ConstituencyResult>& results) {
+        ReportTotals totals;
+        totals.generatedAt = time(0);
+        countSeats(results, totals.tally);
+        totals.constituencies = results.size();
+        totals.candidates = (size_t)candidateCount();
+        totals.parties = (size_t)parties.getSize();
+        const string* largest = nullptr;
+        for (const auto& entry : totals.tally.seats) {
+            if (entry.first == "Independent") continue;
+            if (entry.second > totals.mostSeats) {
+                totals.mostSeats = entry.second;
+                totals.largestParties = 0;
+            }
+            if (entry.second == totals.mostSeats) {
+                totals.largestParties++;
+                largest = &entry.first;
+            }
+        }
+        if (totals.largestParties == 1) {
+            const Party* party = parties.findItem("id", *largest);
+            totals.largestPartyName = party != nullptr ? party->getName() : *largest;
+        }
+        return totals;
+    }
+    
+    // Stream a final report into every format in one pass: each
+    // constituency's candidates in ranking order, then the parties in
+    // ranking order. Rows are read in place from the tables (caller
+    // holds dataMutex). False if a format could not be written.
+    bool streamReport(const vector<ConstituencyResult>& results, const ReportTotals& totals, 
+                      const vector<ReportFormat*>& formats) {
+        TraceSpan span("streamReport");
+        for (ReportFormat* format : formats) format->beginReport(totals);
+        for (const auto& result : results) {
+            const vector<Candidate>& allCandidates = result.shard->candidates.getAllData();
+            for (ReportFormat* format : formats) format->beginConstituency(result);
+            for (size_t i = 0; i < result.ranking.size(); i++) {
+#ifdef X86_SIMD
+                // The ranking visits the table out of order: fetch the
+                // record eight rows ahead, and its name four rows ahead
+                if (i + 8 < result.ranking.size()) {
+                    _mm_prefetch((const char*)&allCandidates[result.ranking[i + 8]], _MM_HINT_T0);
+                }
+                if (i + 4 < result.ranking.size()) {
+                    _mm_prefetch(allCandidates[result.ranking[i + 4]].getName().data(), _MM_HINT_T0);
+                }
+#endif
+                const Candidate& candidate = allCandidates[result.ranking[i]];
+                double percentage = result.totalVotes > 0 ? (double)candidate.getVotes() / result.totalVotes * 100 : 0;
+                for (ReportFormat* format : formats) format->candidateRow(result, i + 1, candidate, percentage);
+            }
+            for (ReportFormat* format : formats) format->endConstituency(result);
+        }
+        
+        vector<int> partyRanking;
+        {
+            TraceSpan rankingSpan("rank parties");
+            partyRanking = partyBoard.ranking();
+        }
+        const vector<Party>& allParties = parties.getAllData();
+        for (ReportFormat* format : formats) format->beginParties(partyRanking.size());
+        for (size_t i = 0; i < partyRanking.size(); i++) {
+            const Party& party = allParties[partyRanking[i]];
+            double percentage = totals.tally.totalVotes > 0 ? (double)party.getTotalVotes() / totals.tally.totalVotes * 100 : 0;
+            auto won = totals.tally.seats.find(party.getId());
+            int seats = won != totals.tally.seats.end() ? won->second : 0;
+            for (ReportFormat* format : formats) format->partyRow(i + 1, party, percentage, seats);
+        }
+        for (ReportFormat* format : formats) format->endReport(totals);
+        
+        bool written = true;
+        for (ReportFormat* format : formats) written = format->finish() && written;
+        return written;
+    }
+    
+    // Batch entry point: run a newline-delimited command file without any
+    // console I/O. Each line is a command and its comma-separated
+    // arguments; empty lines and lines starting with '#' are skipped.
+    //   constituency,<code>,<name>
+    //   party,<name>,<symbol>,<manifesto>
+    //   candidate,<name>,<cnic>,<party ID or empty>,<manifesto>[,<constituency>]
+    //   voter,<username>,<password>,<name>,<cnic>[,<constituency>]
+    //   timing,<start>,<end>                  (Unix times)
+    //   vote,<voter ID>,<candidate ID>
+    //   tally
+    // Every command gets a line "line,command,status[,result]" in
+    // 'resultsFile'. The result is the new ID, or for a tally the total
+    // votes followed by "party:seats" entries.
+    BallotImportSummary runBatch(const string& commandFile, const string& resultsFile) {
+        BallotImportSummary summary;
+        auto start = chrono::steady_clock::now();
+        
+        string buffer;
+        if (!readWholeFile(commandFile, buffer)) {
+            summary.error = "could not read the command file '" + commandFile + "'";
+            return summary;
+        }
+        
+        string out;
+        vector<string> args;
+        string_view text(buffer);
+        size_t lineNumber = 0, pos = 0;
+        while (pos < text.size()) {
+            size_t newline = text.find('\n', pos);
+            if (newline == string_view::npos) newline = text.size();
+            string_view line = text.substr(pos, newline - pos);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            lineNumber++;
+            pos = newline + 1;
+            if (line.empty() || line[0] == '#') continue;
+            
+            args.clear();
+            FieldTokenizer fields(line);
+            while (fields.hasMore()) args.emplace_back(fields.next());
+            string result;
+            bool succeeded = false;
+            string status = runCommand(args, result, succeeded);
+            summary.total++;
+            (succeeded ? summary.accepted : summary.rejected)++;
+            
+            out += to_string(lineNumber) + "," + args[0] + "," + status;
+            if (!result.empty()) out += "," + result;
+            out += "\n";
+        }
+        if (!writeFile(resultsFile, out)) summary.error = "could not write the results file '" + resultsFile + "'";
+        
+        summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return summary;
+    }
+    
+    // One batch command: returns its status text, the new ID or tally in
+    // 'result', and whether it succeeded
+    string runCommand(const vector<string>& args, string& result, bool& succeeded) {
+        const string& command = args[0];
+        size_t count = args.size() - 1;
+        string constituency = count == 5 ? args[5] : "";
+        
+        if (command == "vote" && count == 2) {
+            VoteResult vote = submitVote(args[1], args[2]);
+            succeeded = vote == VoteResult::SUCCESS;
+            return voteResultText(vote);
+        }
+        
+        EngineStatus status = EngineStatus::MALFORMED_COMMAND;
+        if (command == "constituency") {
+            if (count == 2) status = createConstituency(args[1], args[2]);
+        } else if (command == "party") {
+            if (count == 3) status = createParty(args[1], args[2], args[3], &result);
+        } else if (command == "candidate") {
+            if (count == 4 || count == 5) {
+                status = createCandidate(args[1], args[2], args[3], args[4], constituency, &result);
+            }
+        } else if (command == "voter") {
+            if (count == 4 || count == 5) {
+                status = registerVoterAccount(args[1], args[2], args[3], args[4], constituency, &result);
+            }
+        } else if (command == "timing") {
+            long long startTime = 0, endTime = 0;
+            if (count == 2 && parseNumber(args[1], startTime) && parseNumber(args[2], endTime)) {
+                status = setElectionWindow(startTime, endTime);
+            }
+        } else if (command == "tally") {
+            ElectionTally outcome;
+            if (count == 0 && (status = tally(outcome)) == EngineStatus::OK) {
+                result = to_string(outcome.totalVotes);
+                for (const auto& entry : outcome.seats) {
+                    result += ";" + entry.first + ":" + to_string(entry.second);
+                }
+            }
+        } else if (command != "vote") {
+            status = EngineStatus::UNKNOWN_COMMAND;
+        }
+        succeeded = status == EngineStatus::OK;
+        return engineStatusText(status);
+    }
+};
+
+/*
+ * ===================================================================
+ * CONSOLE SESSIONS AS COROUTINES
+ * A session - main menu, login, admin or voter menu - is a C++20
+ * coroutine that suspends at every input prompt instead of blocking on
+ * cin. Its driver feeds it input from any byte stream (the terminal, a
+ * pipe, a socket or a script), so one thread can run thousands of
+ * sessions; a suspended session costs only its coroutine frames.
+ * ===================================================================
+ */
+
+// Bytes held by the coroutine frames of all sessions (--bench-sessions)
+atomic<long long> sessionFrameBytes{0};
+
+// Coroutine frames of sessions are counted
+struct SessionFrame {
+    // Not inlined: GCC otherwise misreports the frame's delete as mismatched
+    [[gnu::noinline]] static void* operator new(size_t size) {
+        sessionFrameBytes += size;
+        return ::operator new(size);
+    }
+    static void operator delete(void* frame, size_t size) {
+        sessionFrameBytes -= size;
+        ::operator delete(frame, size);
+    }
+};
+
+// Result slot of a SessionTask (none for SessionTask<void>)
+template<typename T>
+struct SessionResult {
+    optional<T> value;
+    void return_value(T result) { value = move(result); }
+    T take() { return move(*value); }
+};
+
+template<>
+struct SessionResult<void> {
+    void return_void() {}
+    void take() {}
+};
+
+// One step of a session. It starts when awaited and resumes its caller
+// when it finishes, so nested menus suspend and resume as one chain.
+template<typename T = void>
+class SessionTask {
+public:
+    struct promise_type : SessionFrame, SessionResult<T> {
+        coroutine_handle<> caller;     // Resumed when this step finishes
+        exception_ptr error;
+        
+        SessionTask get_return_object() { 
+            return SessionTask(coroutine_handle<promise_type>::from_promise(*this)); 
+        }
+        suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            struct ResumeCaller {
+                bool await_ready() noexcept { return false; }
+                coroutine_handle<> await_suspend(coroutine_handle<promise_type> step) noexcept {
+                    coroutine_handle<> caller = step.promise().caller;
+                    return caller ? caller : noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            return ResumeCaller{};
+        }
+        void unhandled_exception() { error = current_exception(); }
+    };
+    
+    SessionTask() {}
+    explicit SessionTask(coroutine_handle<promise_type> h) : handle(h) {}
+    SessionTask(SessionTask&& other) noexcept : handle(exchange(other.handle, nullptr)) {}
+    SessionTask& operator=(SessionTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ~SessionTask() {
+        if (handle) handle.destroy(); // Also destroys the steps it is waiting for
+    }
+    
+    // Awaiting a step runs it until its first prompt
+    bool await_ready() const noexcept { return false; }
+    coroutine_handle<> await_suspend(coroutine_handle<> caller) noexcept {
+        handle.promise().caller = caller;
+        return handle;
+    }
+    T await_resume() {
+        if (handle.promise().error) rethrow_exception(handle.promise().error);
+        return handle.promise().take();
+    }
+    
+    // For the driver of a whole session
+    void resume() { handle.resume(); }
+    bool done() const { return !handle || handle.done(); }
+    void rethrowError() const {
+        if (handle && handle.done() && handle.promise().error) rethrow_exception(handle.promise().error);
+    }
+
+private:
+    coroutine_handle<promise_type> handle;
+};
+
+// State of one session: its input, its output stream and the logged-in user
+class ConsoleSession {
+private:
+    string input;                      // Bytes received but not yet read
+    size_t readOffset;
+    coroutine_handle<> waiting;        // Step suspended at a prompt
+    bool hiddenPrompt;                 // The prompt asks for a password
+    SessionTask<> task;
+    
+    // Awaitable: the next input line, suspending until it has arrived
+    struct NextLine {
+        ConsoleSession& session;
+        bool hidden;
+        bool await_ready() const { return session.hasLine(); }
+        void await_suspend(coroutine_handle<> step) {
+            session.waiting = step;
+            session.hiddenPrompt = hidden;
+        }
+        string await_resume() { return session.takeLine(); }
+    };
+    
+    bool hasLine() const { return input.find('\n', readOffset) != string::npos; }
+    
+    string takeLine() {
+        size_t end = input.find('\n', readOffset);
+        string line = input.substr(readOffset, end - readOffset);
+        readOffset = end + 1;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        return line;
+    }
+    
+    NextLine nextLine(const string& prompt, bool hidden = false) {
+        out << prompt;
+        return NextLine{*this, hidden};
+    }
+    
+    static bool isBlank(const string& line) { return line.find_first_not_of(" \t") == string::npos; }
+
+public:
+    ostream& out;
+    Voter voter;                       // This session's copy of the logged-in voter
+    User* user;                        // Pointer for polymorphism (nullptr = logged out)
+    
+    ConsoleSession(ostream& output) : readOffset(0), hiddenPrompt(false), out(output), user(nullptr) {}
+    ConsoleSession(const ConsoleSession&) = delete;
+    
+    // Run 'session' (a coroutine taking this session) up to its first prompt
+    void start(SessionTask<> session) {
+        task = move(session);
+        task.resume();
+        task.rethrowError();
+    }
+    
+    // Deliver input bytes; every complete line answers the pending prompt.
+    // Returns false once the session has ended.
+    bool feed(string_view bytes) {
+        input.append(bytes);
+        while (waiting && hasLine()) {
+            exchange(waiting, nullptr).resume();
+        }
+        input.erase(0, readOffset);
+        readOffset = 0;
+        task.rethrowError();
+        return !finished();
+    }
+    
+    bool finished() const { return task.done(); }
+    bool wantsHiddenInput() const { return hiddenPrompt; }
+    size_t bufferedBytes() const { return input.capacity(); }
+    
+    /*
+     * PROMPTS - each validates its answer and asks again until it is valid
+     */
+    
+    SessionTask<string> readString(string prompt, size_t minLength = 1, size_t maxLength = 100) {
+        while (true) {
+            string line = co_await nextLine(prompt);
+            if (line.length() >= minLength && line.length() <= maxLength) co_return line;
+            out << "Invalid input. Length should be between " << minLength 
+                << " and " << maxLength << " characters." << endl;
+        }
+    }
+    
+    SessionTask<int> readInt(string prompt, int min, int max) {
+        string line = co_await nextLine(prompt);
+        while (true) {
+            // Like cin >> int, blank lines are skipped
+            if (isBlank(line)) {
+                line = co_await nextLine("");
+                continue;
+            }
+            istringstream parser(line);
+            int value;
+            if (parser >> value && value >= min && value <= max) co_return value;
+            out << "Invalid input. Please enter a number between " << min 
+                << " and " << max << "." << endl;
+            line = co_await nextLine(prompt);
+        }
+    }
+    
+    // Pakistani CNIC format: 00000-0000000-0
+    SessionTask<string> readCnic(string prompt) {
+        while (true) {
+            string cnic = co_await nextLine(prompt + " (Format: 00000-0000000-0): ");
+            if (isValidCnicFormat(cnic)) co_return cnic;
+            out << engineStatusText(EngineStatus::INVALID_CNIC) << endl;
+        }
+    }
+    
+    // The terminal driver reads the answer without echoing it
+    SessionTask<string> readPassword(string prompt) {
+        co_return co_await nextLine(prompt, true);
+    }
+    
+    // Date and time as "YYYY MM DD HH MM" (may span lines)
+    SessionTask<time_t> readDateTime(string prompt) {
+        string text = co_await nextLine(prompt + " (YYYY MM DD HH MM): ");
+        while (true) {
+            istringstream fields(text);
+            int year, month, day, hour, minute;
+            if (fields >> year >> month >> day >> hour >> minute) {
+                if (year >= 2024 && month >= 1 && month <= 12 && day >= 1 && day <= 31 &&
+                    hour >= 0 && hour <= 23 && minute >= 0 && minute <= 59) {
+                    struct tm timeinfo = {};
+                    timeinfo.tm_year = year - 1900;
+                    timeinfo.tm_mon = month - 1;
+                    timeinfo.tm_mday = day;
+                    timeinfo.tm_hour = hour;
+                    timeinfo.tm_min = minute;
+                    timeinfo.tm_sec = 0;
+                    co_return mktime(&timeinfo);
+                }
+            } else if (fields.eof()) {
+                text += " " + co_await nextLine(""); // Not all five numbers yet
+                continue;
+            }
+            out << "Invalid date/time format. Please use YYYY MM DD HH MM format." << endl;
+            text = co_await nextLine(prompt + " (YYYY MM DD HH MM): ");
+        }
+    }
+    
+    // y/n question; true for 'y' or 'Y'
+    SessionTask<bool> readConfirm(string prompt) {
+        string line = co_await nextLine(prompt);
+        while (isBlank(line)) line = co_await nextLine("");
+        char answer = line[line.find_first_not_of(" \t")];
+        co_return answer == 'y' || answer == 'Y';
+    }
+};
+
+/*
+ * ===================================================================
+ * MAIN VOTING SYSTEM CLASS - the console client of the engine
+ * OOP CONCEPT: Inheritance - VotingSystem IS-A ElectionEngine with menus
+ * The menus prompt for input, call the engine's typed calls and turn
+ * their status codes into messages.
+ * ===================================================================
+ */
+class VotingSystem : public ElectionEngine {
+public:
+    VotingSystem(const SystemOptions& opts = SystemOptions()) : ElectionEngine(opts, &cout) {}
+    
+    // Print a failed call's status; true if it succeeded
+    static bool reportStatus(EngineStatus status, ostream& out = cout) {
+        if (status == EngineStatus::OK) return true;
+        out << engineStatusText(status) << "!" << endl;
+        return false;
+    }
+    
+    /*
+     * ===================================================================
+     * TERMINAL INPUT METHODS
+     * Blocking prompts on cin for clients without sessions (the kiosk
+     * client); session menus use the prompts of ConsoleSession
+     * ===================================================================
+     */
+    
+    // Validate string input with length constraints
+    static string getValidatedString(const string& prompt, size_t minLength = 1, size_t maxLength = 100) {
+        string input;
+        while (true) {
+            cout << prompt;
+            getline(cin, input);
+            
+            if (input.length() >= minLength && input.length() <= maxLength) {
+                return input;
+            }
+            cout << "Invalid input. Length should be between " << minLength 
+                 << " and " << maxLength << " characters." << endl;
+        }
+    }
+    
+    // Validate integer input with range constraints
+    static int getValidatedInt(const string& prompt, int min, int max) {
+        int input;
+        while (true) {
+            cout << prompt;
+            if (cin >> input && input >= min && input <= max) {
+                cin.ignore(); // Clear input buffer
+                return input;
+            }
+            cout << "Invalid input. Please enter a number between " << min 
+                 << " and " << max << "." << endl;
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        }
+    }
+
+    static string getHiddenPassword(const string& prompt) {
+    string password;
+    char ch;
+    
+    cout << prompt;
+    
+    // #ifdef _WIN32
+        while ((ch = _getch()) != '\r') {
+            if (ch == '\b') {
+                if (!password.empty()) {
+                    password.pop_back();
+                    cout << "\b \b";
+                }
+            } else {
+                    password += ch;
+                    cout << '*';
+            }
+        }
+    // #endif
+        cout << endl;
+        return password;
+    }
+    
+    /*
+     * ===================================================================
+     * CONSTITUENCY MANAGEMENT METHODS
+     * ===================================================================
+     */
+    
+    SessionTask<> manageConstituencies(ConsoleSession& session) {
+        ostream& out = session.out;
+        while (true) {
+            out << "\n=== CONSTITUENCY MANAGEMENT ===" << endl;
+            out << "1. Add New Constituency" << endl;
+            out << "2. View All Constituencies" << endl;
+            out << "3. Back to Main Menu" << endl;
+            
+            int choice = co_await session.readInt("Enter your choice: ", 1, 3);
+            
+            switch (choice) {
+                case 1: co_await addConstituency(session); break;
+                case 2: viewAllConstituencies(out); break;
+                case 3: co_return;
+            }
+        }
+    }
+    
+    SessionTask<> addConstituency(ConsoleSession& session) {
+        ostream& out = session.out;
+        out << "\n=== ADD NEW CONSTITUENCY ===" << endl;
+        
+        string code = co_await session.readString("Constituency Code (e.g. NA-2): ", 1, 10);
+        if (!Constituency::isValidCode(code)) {
+            reportStatus(EngineStatus::INVALID_CODE, out);
+            co_return;
+        }
+        string name = co_await session.readString("Constituency Name: ", 2, 50);
+        
+        if (reportStatus(createConstituency(code, name), out)) {
+            out << "Constituency added successfully!" << endl;
+        }
+    }
+    
+    void viewAllConstituencies(ostream& out = cout) {
+        out << "\n=== ALL CONSTITUENCIES ===" << endl;
+        out << left << setw(10) << "Code" << setw(30) << "Name" << setw(12) << "Candidates" 
+            << setw(12) << "Voters" << setw(12) << "Votes Cast" << endl;
+        out << string(76, '-') << endl;
+        
+        shared_lock<shared_mutex> lock(dataMutex);
+        loadAllVoters();
+        for (const auto& shard : constituencies) {
+            shared_lock<shared_mutex> shardLock(shard->shardMutex);
+            int votesCast = 0;
+            for (const auto& candidate : shard->candidates.getAllData()) {
+                votesCast += candidate.getVotes();
+            }
+            out << left << setw(10) << shard->code
+                << setw(30) << shard->name
+                << setw(12) << shard->candidates.getSize()
+                << setw(12) << shard->voters.getSize()
+                << setw(12) << votesCast << endl;
+        }
+    }
+    
+    // Constituency for a new candidate or voter: asked only when there is
+    // more than one. Returns "" for an unknown code.
+    SessionTask<string> selectConstituency(ConsoleSession& session) {
+        if (constituencies.size() == 1) {
+            co_return constituencies.front()->code;
+        }
+        viewAllConstituencies(session.out);
+        string code = co_await session.readString("Constituency Code: ", 1, 10);
+        shared_lock<shared_mutex> lock(dataMutex);
+        co_return findConstituency(code) != nullptr ? code : "";
+    }
+    
+    /*
+     * ===================================================================
+     * PARTY MANAGEMENT METHODS
+     * These handle party-related operations
+     * ===================================================================
+     */
+    
+    SessionTask<> manageParties(ConsoleSession& session) {
+        ostream& out = session.out;
+        while (true) {
+            out << "\n=== PARTY MANAGEMENT ===" << endl;
+            out << "1. Add New Party" << endl;
+            out << "2. View All Parties" << endl;
+            out << "3. View Party Details" << endl;
+            out << "4. Back to Main Menu" << endl;
+            
+            int choice = co_await session.readInt("Enter your choice: ", 1, 4);
+            
+            switch (choice) {
+                case 1: co_await addParty(session); break;
+                case 2: viewAllParties(out); break;
+                case 3: co_await viewPartyDetails(session); break;
+                case 4: co_return;
+            }
+        }
+    }
+    
+    SessionTask<> addParty(ConsoleSession& session) {
+        ostream& out = session.out;
+        out << "\n=== ADD NEW PARTY ===" << endl;
+        
+        string name = co_await session.readString("Party Name: ", 2, 50);
+        string symbol = co_await session.readString("Party Symbol: ", 1, 20);
+        string manifesto = co_await session.readString("Party Manifesto: ", 10, 500);
+        
+        if (reportStatus(createParty(name, symbol, manifesto), out)) {
+            out << "Party added successfully!" << endl;
+        }
+    }
+    
+    void viewAllParties(ostream& out = cout) {
+        out << "\n=== ALL PARTIES ===" << endl;
+        if (parties.getSize() == 0) {
+            out << "No parties registered." << endl;
+            return;
+        }
+        
+        out << left << setw(10) << "ID" << setw(30) << "Name" << setw(15) << "Symbol" 
+            << setw(12) << "Candidates" << setw(12) << "Total Votes" << endl;
+        out << string(82, '-') << endl;
+        
+        for (const auto& party : parties.getAllData()) {
+            out << left << setw(10) << party.getId()
+                << setw(30) << party.getName()
+                << setw(15) << party.getSymbol()
+                << setw(12) << party.getCandidateIds().size()
+                << setw(12) << party.getTotalVotes() << endl;
+        }
+    }
+    
+    SessionTask<> viewPartyDetails(ConsoleSession& session) {
+        ostream& out = session.out;
+        if (parties.getSize() == 0) {
+            out << "No parties available." << endl;
+            co_return;
+        }
+        
+        viewAllParties(out);
+        string partyId = co_await session.readString("Enter Party ID to view details: ");
+        
+        const Party* party = parties.findItem("id", partyId);
+        if (party == nullptr) {
+            out << "Party not found!" << endl;
+            co_return;
+        }
+        
+        out << "\n=== PARTY DETAILS ===" << endl;
+        out << "Party ID: " << party->getId() << endl;
+        out << "Party Name: " << party->getName() << endl;
+        out << "Symbol: " << party->getSymbol() << endl;
+        out << "Manifesto: " << party->getManifesto() << endl;
+        out << "Total Votes: " << party->getTotalVotes() << endl;
+        out << "Number of Candidates: " << party->getCandidateIds().size() << endl;
+        
+        // Show party candidates
+        if (party->hasCandidates()) {
+            out << "\nParty Candidates:" << endl;
+            for (const string& candidateId : party->getCandidateIds()) {
+                const Candidate* candidate = findCandidate(candidateId);
+                if (candidate != nullptr) {
+                    out << "- " << candidate->getName() 
+                        << " (ID: " << candidate->getId() 
+                        << ", Votes: " << candidate->getVotes() << ")" << endl;
+                }
+            }
+        }
+    }
+    
+    /*
+     * ===================================================================
+     * USER AUTHENTICATION METHODS
+     * OOP CONCEPT: Polymorphism - different types of users
+     * ===================================================================
+     */
+    
+    // OOP CONCEPT: Polymorphism - returns pointer to base class User
+    SessionTask<User*> login(ConsoleSession& session) {
+        ostream& out = session.out;
+        out << "\n=== LOGIN ===" << endl;
+        string username = co_await session.readString("Username: ");
+        string password = co_await session.readPassword("Password: ");
+        
+        User* user = authenticate(username, password, session.voter);
+        if (user == &admin) {
+            out << "Admin login successful!" << endl;
+        } else if (user != nullptr) {
+            out << "Voter login successful!" << endl;
+        } else {
+            out << "Invalid credentials!" << endl;
+        }
+        co_return user;
+    }
+    
+    /*
+     * ===================================================================
+     * CANDIDATE MANAGEMENT METHODS
+     * ===================================================================
+     */
+    
+    SessionTask<> addCandidate(ConsoleSession& session) {
+        ostream& out = session.out;
+        out << "\n=== ADD CANDIDATE ===" << endl;
+        
+        string name = co_await session.readString("Candidate Name: ", 2, 50);
+        string cnic = co_await session.readCnic("Candidate CNIC");
+        
+        // Check if CNIC already exists
+        if (cnicExists(cnic)) {
+            reportStatus(EngineStatus::DUPLICATE_CNIC, out);
+            co_return;
+        }
+        
+        string constituency = co_await selectConstituency(session);
+        if (constituency.empty()) {
+            reportStatus(EngineStatus::UNKNOWN_CONSTITUENCY, out);
+            co_return;
+        }
+        
+        out << "\nCandidate Type:" << endl;
+        out << "1. Independent Candidate" << endl;
+        out << "2. Party Candidate" << endl;
+        int type = co_await session.readInt("Select type: ", 1, 2);
+        
+        if (type == 1) {
+            // Independent candidate
+            string manifesto = co_await session.readString("Personal Manifesto: ", 10, 200);
+            if (reportStatus(createCandidate(name, cnic, "", manifesto, constituency), out)) {
+                out << "Independent candidate added successfully!" << endl;
+            }
+        } else {
+            // Party candidate
+            if (parties.getSize() == 0) {
+                out << "No parties available. Please add a party first." << endl;
+                co_return;
+            }
+            
+            viewAllParties(out);
+            string partyId = co_await session.readString("Enter Party ID: ");
+            
+            // Verify party exists
+            if (getPartyVotes(partyId) < 0) {
+                reportStatus(EngineStatus::UNKNOWN_PARTY, out);
+                co_return;
+            }
+            
+            string manifesto = co_await session.readString("Candidate Manifesto: ", 10, 200);
+            if (reportStatus(createCandidate(name, cnic, partyId, manifesto, constituency), out)) {
+                out << "Party candidate added successfully!" << endl;
+            }
+        }
+    }
+    
+    void viewAllCandidates(ostream& out = cout) {
+        out << "\n=== ALL CANDIDATES ===" << endl;
+        shared_lock<shared_mutex> lock(dataMutex);
+        if (candidateCount() == 0) {
+            out << "No candidates registered." << endl;
+            return;
+        }
+        
+        out << left << setw(10) << "ID" << setw(20) << "Name" << setw(25) << "CNIC" 
+            << setw(12) << "Party/Type" << setw(14) << "Constituency" << setw(10) << "Votes" << endl;
+        out << string(89, '-') << endl;
+        
+        for (const auto& shard : constituencies) {
+            for (const auto& candidate : shard->candidates.getAllData()) {
+                string partyInfo = candidate.getIsIndependent() ? "Independent" : candidate.getPartyId();
+                out << left << setw(10) << candidate.getId()
+                    << setw(20) << candidate.getName()
+                    << setw(25) << candidate.getCnic()
+                    << setw(12) << partyInfo
+                    << setw(14) << shard->code
+                    << setw(10) << candidate.getVotes() << endl;
+            }
+        }
+    }
+
+    // Candidates on the voter's ballot (all constituencies if 'voterId' is
+    // unknown); 'out' lets scripted sessions render the table off-screen
+    void viewAllCandidatesForVoter(const string& voterId, ostream& out = cout) {
+        shared_lock<shared_mutex> lock(dataMutex);
+        Constituency* own = findVoterConstituency("id", voterId);
+        out << "\n=== ALL CANDIDATES ===" << endl;
+        if (own != nullptr) {
+            out << "Constituency: " << own->code << " (" << own->name << ")" << endl;
+        }
+        if ((own != nullptr ? own->candidates.getSize() : candidateCount()) == 0) {
+            out << "No candidates registered." << endl;
+            return;
+        }
+        
+        out << left << setw(10) << "ID" << setw(20) << "Name" << setw(25) << "CNIC" 
+            << setw(12) << "Party/Type" << endl;
+        out << string(75, '-') << endl;
+        
+        for (const auto& shard : constituencies) {
+            if (own != nullptr && shard.get() != own) continue;
+            for (const auto& candidate : shard->candidates.getAllData()) {
+                string partyInfo = candidate.getIsIndependent() ? "Independent" : candidate.getPartyId();
+                out << left << setw(10) << candidate.getId()
+                    << setw(20) << candidate.getName()
+                    << setw(25) << candidate.getCnic()
+                    << setw(12) << partyInfo << endl;
+            }
+        }
+    }
+    
+    /*
+     * ===================================================================
+     * VOTER MANAGEMENT METHODS
+     * ===================================================================
+     */
+    
+    SessionTask<> registerVoter(ConsoleSession& session) {
+        ostream& out = session.out;
+        out << "\n=== REGISTER VOTER ===" << endl;
+        
+        string username = co_await session.readString("Username: ", 3, 20);
+        
+        // Check if username already exists
+        if (usernameExists(username)) {
+            reportStatus(EngineStatus::DUPLICATE_USERNAME, out);
+            co_return;
+        }
+        
+        string password = co_await session.readString("Password: ", 6, 20);
+        string name = co_await session.readString("Full Name: ", 2, 50);
+        
+        string cnic = co_await session.readCnic("CNIC");
+        
+        // Check if CNIC already exists
+        if (cnicExists(cnic)) {
+            reportStatus(EngineStatus::DUPLICATE_CNIC, out);
+            co_return;
+        }
+        
+        string constituency = co_await selectConstituency(session);
+        if (constituency.empty()) {
+            reportStatus(EngineStatus::UNKNOWN_CONSTITUENCY, out);
+            co_return;
+        }
+        
+        // Re-checked under the lock in case another session registered first
+        string id;
+        if (reportStatus(registerVoterAccount(username, password, name, cnic, constituency, &id), out)) {
+            out << "Voter registered successfully! (Voter ID: " << id << ")" << endl;
+        }
+    }
+    
+    // Print a voter's status - shared by the voter menu and scripted sessions
+    void viewVotingStatus(const string& voterId, ostream& out = cout) {
+        shared_lock<shared_mutex> lock(dataMutex);
+        Constituency* shard = findVoterConstituency("id", voterId);
+        if (shard == nullptr) return;
+        shared_lock<shared_mutex> shardLock(shard->shardMutex);
+        VoterView voter = shard->voters[shard->voters.find("id", voterId)];
+        
+        out << "\n=== VOTING STATUS ===" << endl;
+        out << "Constituency: " << shard->code << " (" << shard->name << ")" << endl;
+        out << "Has Voted: " << (voter.getHasVoted() ? "Yes" : "No") << endl;
+        if (voter.getHasVoted()) {
+            out << "Voted For: " << voter.getVotedFor() << endl;
+        }
+    }
+    
+    void viewAllVoters(ostream& out = cout) {
+        out << "\n=== ALL VOTERS ===" << endl;
+        shared_lock<shared_mutex> lock(dataMutex);
+        loadAllVoters();
+        if (voterCount() == 0) {
+            out << "No voters registered." << endl;
+            return;
+        }
+        
+        out << left << setw(15) << "Username" << setw(25) << "Name" << setw(25) << "CNIC" 
+            << setw(12) << "Voter ID" << setw(14) << "Constituency" << setw(10) << "Voted" << endl;
+        out << string(99, '-') << endl;
+        
+        for (const auto& shard : constituencies) {
+            shared_lock<shared_mutex> shardLock(shard->shardMutex);
+            for (const auto& voter : shard->voters) {
+                out << left << setw(15) << voter.getUsername()
+                    << setw(25) << voter.getName()
+                    << setw(25) << voter.getCnic()
+                    << setw(12) << voter.getId()
+                    << setw(14) << shard->code
+                    << setw(10) << (voter.getHasVoted() ? "Yes" : "No") << endl;
+            }
+        }
+    }
+    
+    /*
+     * ===================================================================
+     * VOTING METHODS
+     * ===================================================================
+     */
+    
+    SessionTask<> castVote(ConsoleSession& session) {
+        ostream& out = session.out;
+        Voter& voter = session.voter;
+        if (!timer.isElectionActive()) {
+            out << "Election is not currently active!" << endl;
+            out << "Status: " << timer.getStatus() << endl;
+            co_return;
+        }
+        
+        // The session holds a copy of the voter, so check the stored record
+        Constituency* shard = findVoterConstituency("id", voter.getId());
+        if (shard != nullptr) {
+            shared_lock<shared_mutex> shardLock(shard->shardMutex);
+            VoterView record = shard->voters[shard->voters.find("id", voter.getId())];
+            if (record.getHasVoted()) {
+                out << "You have already voted!" << endl;
+                out << "You voted for candidate: " << record.getVotedFor() << endl;
+                co_return;
+            }
+        }
+        
+        // Only the candidates of the voter's own constituency are on the ballot
+        if (shard == nullptr || shard->candidates.getSize() == 0) {
+            out << "No candidates available for voting." << endl;
+            co_return;
+        }
+        
+        out << "\n=== CAST VOTE ===" << endl;
+        out << "Constituency: " << shard->code << " (" << shard->name << ")" << endl;
+        out << "Available Candidates:" << endl;
+        out << left << setw(10) << "ID" << setw(20) << "Name" << setw(15) << "Party/Type" << endl;
+        out << string(45, '-') << endl;
+        
+        for (const auto& candidate : shard->candidates.getAllData()) {
+            string partyInfo = candidate.getIsIndependent() ? "Independent" : candidate.getPartyId();
+            out << left << setw(10) << candidate.getId()
+                << setw(20) << candidate.getName()
+                << setw(15) << partyInfo << endl;
+        }
+        
+        string candidateId = co_await session.readString("Enter Candidate ID to vote for: ");
+        
+        // Find and validate candidate
+        const Candidate* candidate = shard->candidates.findItem("id", candidateId);
+        if (candidate == nullptr) {
+            out << "Invalid candidate ID!" << endl;
+            co_return;
+        }
+        string candidateName = candidate->getName();
+        
+        // Confirm vote
+        out << "You are about to vote for: " << candidateName << endl;
+        if (co_await session.readConfirm("Are you sure? (y/n): ")) {
+            switch (submitVote(voter.getId(), candidateId)) {
+                case VoteResult::SUCCESS:
+                    voter.castVote(candidateId); // Keep the session copy in step
+                    out << "Vote cast successfully!" << endl;
+                    break;
+                case VoteResult::ALREADY_VOTED:
+                    out << "You have already voted!" << endl;
+                    break;
+                case VoteResult::ELECTION_CLOSED:
+                    out << "Election is not currently active!" << endl;
+                    break;
+                default:
+                    out << "Vote could not be recorded." << endl;
+                    break;
+            }
+        } else {
+            out << "Vote cancelled." << endl;
+        }
+    }
+    
+    // Admin: bulk-import offline ballots from a polling station file
+    SessionTask<> importBallots(ConsoleSession& session) {
+        ostream& out = session.out;
+        out << "\n=== IMPORT BALLOT FILE ===" << endl;
+        out << "Each line must be: VoterID,CandidateID" << endl;
+        string ballotFile = co_await session.readString("Ballot file: ");
+        
+        if (!ifstream(ballotFile).is_open()) {
+            out << "Cannot open '" << ballotFile << "'!" << endl;
+            co_return;
+        }
+        
+        string rejectsFile = ballotFile + ".rejects.txt";
+        BallotImportSummary summary = ingestBallots(ballotFile, rejectsFile);
+        printImportSummary(summary, rejectsFile, out);
+    }
+    
+    static void printBatchSummary(const BallotImportSummary& summary, const string& resultsFile) {
+        if (!summary.error.empty()) cout << "Error: " << summary.error << "." << endl;
+        if (summary.total == 0 && !summary.error.empty()) return;
+        cout << "Commands run: " << summary.total << endl;
+        cout << "Succeeded: " << summary.accepted << endl;
+        cout << "Failed: " << summary.rejected << " (results in '" << resultsFile << "')" << endl;
+        if (summary.seconds > 0) {
+            cout << "Throughput: " << fixed << setprecision(0) 
+                 << summary.total / summary.seconds << " commands/second" << endl;
+        }
+    }
+    
+    static void printImportSummary(const BallotImportSummary& summary, const string& rejectsFile, 
+                                   ostream& out = cout) {
+        out << "Ballots read: " << summary.total << endl;
+        out << "Accepted: " << summary.accepted << endl;
+        out << "Rejected: " << summary.rejected;
+        if (summary.rejected > 0) out << " (reasons in '" << rejectsFile << "')";
+        out << endl;
+        if (summary.seconds > 0) {
+            out << "Throughput: " << fixed << setprecision(0) 
+                << summary.total / summary.seconds * 60 << " ballots/minute" << endl;
+        }
+    }
+    
+    /*
+     * ===================================================================
+     * ELECTION TIMING METHODS
+     * ===================================================================
+     */
+    
+    SessionTask<> setElectionTiming(ConsoleSession& session) {
+        ostream& out = session.out;
+        out << "\n=== SET ELECTION TIMING ===" << endl;
+        
+        time_t currentTime = time(0);
+        out << "Current time: " << ctime(&currentTime);
+        
+        time_t startTime = co_await session.readDateTime("Enter election start time");
+        time_t endTime = co_await session.readDateTime("Enter election end time");
+        
+        if (!reportStatus(setElectionWindow(startTime, endTime), out)) co_return;
+        out << "Election timing set successfully!" << endl;
+        
+        out << "Election Start: " << ctime(&startTime);
+        out << "Election End: " << ctime(&endTime);
+    }
+    
+    // Size and measured false-positive rate of the CNIC pre-filter
+    void printCnicFilterStats(ostream& out = cout) const {
+        shared_lock<shared_mutex> lock(dataMutex);
+        out << "CNIC filter: " << cnicFilter.getKeyCount() << " CNICs, " << cnicFilter.memoryUsage() / 1024 
+            << " KB, " << cnicFilter.getFilteredOut() << " lookups answered without the records, "
+            << "false-positive rate " << fixed << setprecision(3) << cnicFilter.falsePositiveRate() * 100 << "%" 
+            << endl;
+    }
+    
+    void printPersistenceStats(ostream& out = cout) const {
+        out << "Persistence: " << journal.getPendingRecords() << " of " << journal.getCapacity() 
+            << " journal records queued, " << journal.getBackPressureWaits() << " waits for queue space, "
+            << backgroundSaves << " background saves";
+        if (backgroundSaves > 0) out << " (last " << lastSaveMicros / 1000.0 << " ms)";
+        out << endl;
+    }
+    
+    void viewElectionStatus(ostream& out = cout) {
+        out << "\n=== ELECTION STATUS ===" << endl;
+        out << "Status: " << timer.getStatus() << endl;
+        
+        if (timer.isTimingSet()) {
+            time_t start = timer.getStartTime();
+            time_t end = timer.getEndTime();
+            out << "Start Time: " << ctime(&start);
+            out << "End Time: " << ctime(&end);
+        }
+        
+        int registered = 0, candidateTotal = 0, votesCast = 0;
+        {
+            shared_lock<shared_mutex> lock(dataMutex);
+            loadAllVoters();
+            registered = voterCount();
+            candidateTotal = candidateCount();
+            // Count votes cast (popcount of each has-voted bitset)
+            for (const auto& shard : constituencies) {
+                shared_lock<shared_mutex> shardLock(shard->shardMutex);
+                votesCast += shard->voters.countVoted();
+            }
+            out << "Total Constituencies: " << constituencies.size() << endl;
+        }
+        out << "Total Registered Voters: " << registered << endl;
+        out << "Total Candidates: " << candidateTotal << endl;
+        out << "Total Parties: " << parties.getSize() << endl;
+        out << "Votes Cast: " << votesCast << endl;
+        printCnicFilterStats(out);
+        printPersistenceStats(out);
+        const char* idCheck[] = {"not run (start with --verify-ids)", "running", "consistent with the data", 
+                                 "counters were behind the data and have been raised"};
+        out << "Next IDs: candidate " << nextCandidateId << ", party " << nextPartyId << ", voter " 
+            << nextVoterId << " (check: " << idCheck[idCheckState] << ")" << endl;
+        
+        if (registered > 0) {
+            double turnout = (double)votesCast / registered * 100;
+            out << "Voter Turnout: " << fixed << setprecision(2) << turnout << "%" << endl;
+        }
+        
+        if (candidateTotal > 0) {
+            viewLiveResults(5, out);
+        }
+    }
+    
+    // Counters, gauges and latency percentiles since startup
+    void viewSystemMetrics(ostream& out = cout) {
+        out << "\n=== SYSTEM METRICS ===" << endl;
+        refreshGauges();
+        metrics.printSummary(out);
+        out << "Saved to " << dataPath("metrics.prom");
+        if (options.metricsIntervalMs > 0) out << " every " << options.metricsIntervalMs << " ms and";
+        out << " at exit" << endl;
+    }
+    
+    /*
+     * ===================================================================
+     * ELECTION REPORT GENERATION
+     * ===================================================================
+     */
+    
+    void generateElectionReport(ostream& out = cout) {
+        out << "\n=== ELECTION REPORT ===" << endl;
+        
+        if (!timer.hasElectionEnded()) {
+        out << "Election is still ongoing. Report will be available after election ends." << endl;
+        return;
+        }
+        
+        LatencyTimer timing(reportLatency);
+        TraceSpan span("generateElectionReport");
+        journal.flush(); // Flush barrier: every counted vote is on the disk
+        shared_lock<shared_mutex> lock(dataMutex);
+        vector<ConstituencyResult> results = tallyConstituencies();
+        ReportTotals totals = reportTotals(results);
+        
+        if (totals.tally.totalVotes == 0) {
+            out << "No votes have been cast yet." << endl;
+            return;
+        }
+        
+        // The screen and the report files are written in the same pass
+        ConsoleReport screen(out);
+        TextReport text(dataPath("election_report.txt"));
+        CsvReport csv(dataPath("election_report.csv"), dataPath("election_report_parties.csv"));
+        JsonReport json(dataPath("election_report.json"));
+        if (streamReport(results, totals, {&screen, &text, &csv, &json})) {
+            out << "\nReport saved to 'election_report.txt', 'election_report.csv', "
+                << "'election_report_parties.csv' and 'election_report.json'" << endl;
+        } else {
+            out << "\nWarning: the report files could not be written." << endl;
+        }
+    }
+    
+    // Live results: top-k parties and the current leader of every
+    // constituency straight from the leaderboards, cheap enough to refresh
+    // every second
+    void viewLiveResults(size_t k = 5, ostream& out = cout) {
+        shared_lock<shared_mutex> lock(dataMutex);
+        const vector<Party>& allParties = parties.getAllData();
+        
+        out << "\n--- Live Results ---" << endl;
+        if (!allParties.empty()) {
+            out << "Top " << k << " Parties:" << endl;
+            for (const auto& entry : partyBoard.top(k)) {
+                out << left << setw(10) << allParties[entry.first].getId() 
+                    << setw(20) << allParties[entry.first].getName() << entry.second << " votes" << endl;
+            }
+        }
+        out << "Constituency Leaders:" << endl;
+        for (const auto& shard : constituencies) {
+            vector<int> leaders = shard->candidateBoard.leaders();
+            if (leaders.empty()) continue;
+            const Candidate& leader = shard->candidates.getAllData()[leaders[0]];
+            out << left << setw(10) << shard->code << setw(20) << leader.getName() << leader.getVotes() << " votes";
+            if (leaders.size() > 1 && leader.getVotes() > 0) {
+                out << " (tied with " << leaders.size() - 1 << " more)";
+            }
+            out << endl;
+        }
+    }
+    
+    /*
+     * ===================================================================
+     * MAIN SYSTEM CONTROL METHODS
+     * ===================================================================
+     */
+    
+    // Console on the terminal: one session driven by cin
+    void runSystem() {
+        ConsoleSession session(cout);
+        session.start(runSession(session));
+        string line;
+        while (!session.finished()) {
+            if (session.wantsHiddenInput()) {
+                line = getHiddenPassword(""); // Echoed as '*' characters
+            } else if (!getline(cin, line)) {
+                break; // End of input
+            }
+            session.feed(line + "\n");
+        }
+    }
+    
+    // A whole session, from the main menu to Exit
+    SessionTask<> runSession(ConsoleSession& session) {
+        ostream& out = session.out;
+        out << "\n=== ELECTRONIC VOTING SYSTEM ===" << endl;
+        out << "Welcome to the Digital Democracy Platform" << endl;
+        
+        while (true) {
+            out << "\n=== DIGITAL VOTING SYSTEM ===" << endl;
+            out << "1. Login as Admin" << endl;
+            out << "2. Login as Voter" << endl;
+            out << "3. Check Election Results (Public)" << endl;
+            out << "4. Exit" << endl;
+            
+            int choice = co_await session.readInt("Enter your choice: ", 1, 4);
+            
+            switch (choice) {
+                case 1:
+                case 2:
+                    session.user = co_await login(session);
+                    if (session.user != nullptr) {
+                        co_await handleUserSession(session);
+                    }
+                    break;
+                case 3:
+                    generateElectionReport(out);
+                    break;
+                case 4:
+                    out << "Thank you for using the Digital Voting System!" << endl;
+                    co_return;
+            }
+        }
+    }
+    
+    SessionTask<> handleUserSession(ConsoleSession& session) {
+        while (session.user != nullptr) {
+            session.user->displayMenu(session.out);
+            
+            // Check if admin or voter
+            if (dynamic_cast<Admin*>(session.user)) {
+                co_await handleAdminMenu(session);
+            } else if (dynamic_cast<Voter*>(session.user)) {
+                co_await handleVoterMenu(session);
+            }
+        }
+    }
+    
+    SessionTask<> handleAdminMenu(ConsoleSession& session) {
+        int choice = co_await session.readInt("Enter your choice: ", 1, 12);
+        
+        switch (choice) {
+            case 1: co_await manageParties(session); break;
+            case 2: co_await addCandidate(session); break;
+            case 3: viewAllCandidates(session.out); break;
+            case 4: co_await registerVoter(session); break;
+            case 5: viewAllVoters(session.out); break;
+            case 6: co_await setElectionTiming(session); break;
+            case 7: viewElectionStatus(session.out); break;
+            case 8: generateElectionReport(session.out); break;
+            case 9: co_await importBallots(session); break;
+            case 10: co_await manageConstituencies(session); break;
+            case 11: viewSystemMetrics(session.out); break;
+            case 12: 
+                session.out << "Logging out..." << endl;
+                session.user = nullptr;
+                break;
+        }
+    }
+    
+    SessionTask<> handleVoterMenu(ConsoleSession& session) {
+        int choice = co_await session.readInt("Enter your choice: ", 1, 5);
+        const string& voterId = session.voter.getId();
+        
+        switch (choice) {
+            case 1: viewAllCandidatesForVoter(voterId, session.out); break;
+            case 2: viewAllParties(session.out); break;
+            case 3: co_await castVote(session); break;
+            case 4: viewVotingStatus(voterId, session.out); break;
+            case 5:
+                session.out << "Logging out..." << endl;
+                session.user = nullptr;
+                break;
+        }
+    }
+};
+
+/*
+ * ===================================================================
+ * MAIN FUNCTION - ENTRY POINT OF THE PROGRAM
+ * ===================================================================
+ */
+/*
+ * ===================================================================
+ * BENCHMARK MODES
+ * Command-line tools for measuring the system on synthetic data
+ * ===================================================================
+ */
+
+// Format a number as a unique, valid CNIC (00000-0000000-0)
+string makeSyntheticCnic(long long n) {
+    string digits = to_string(3520000000000LL + n); // 13 digits
+    return digits.substr(0, 5) + "-" + digits.substr(5, 7) + "-" + digits.substr(12, 1);
+}
+
+// Comma-separated numbers of a command-line option; false if one of
+// them is not a number
+template<typename Integer>
+bool parseNumberList(string_view text, vector<Integer>& values) {
+    FieldTokenizer list(text);
+    while (list.hasMore()) {
+        Integer value = 0;
+        if (!parseNumber(list.next(), value)) return false;
+        values.push_back(value);
+    }
+    return true;
+}
+
+// Value of a numeric command-line option; false (after printing
+// "Invalid <option>: <value>") if it is not a number
+template<typename Integer>
+bool parseOption(const string& option, const char* text, Integer& value) {
+    if (parseNumber(string_view(text), value)) return true;
+    cout << "Invalid " << option << ": " << text << endl;
+    return false;
+}
+
+// Optional count after an option: argv[i + 1] is taken (and 'i'
+// advanced) only if it is a number, so a following option is left
+// alone; otherwise 'value' keeps its default
+template<typename Integer>
+void parseOptionalNumber(int argc, char* argv[], int& i, Integer& value) {
+    if (i + 1 < argc && parseNumber(string_view(argv[i + 1]), value)) i++;
+}
+
+// Thread counts for a scaling run: the powers of two below 'maxThreads',
+// then 'maxThreads' itself
+vector<unsigned> threadCountSteps(unsigned maxThreads) {
+    vector<unsigned> steps;
+    for (unsigned t = 1; t < maxThreads; t *= 2) steps.push_back(t);
+    steps.push_back(max(1u, maxThreads));
+    return steps;
+}
+
+// Write 'rows' synthetic voters in the voters.txt format
+void writeSyntheticVoters(const string& filename, long long rows) {
+    ofstream file(filename);
+    for (long long i = 0; i < rows; i++) {
+        Voter voter("user" + to_string(i), "pass" + to_string(i), "Voter Number " + to_string(i),
+                    to_string(10001 + i), makeSyntheticCnic(i));
+        file << voter.toString() << '\n';
+    }
+}
+
+// Write a complete synthetic election (constituency list, per-constituency
+// voter and candidate files, parties.txt) into 'directory'. Voters and
+// candidates are dealt round-robin to constituencies NA-1 ... NA-n. CNICs
+// are valid and unique across voters and candidates; every fifth
+// candidate is independent.
+void generateSyntheticData(const string& directory, long long voterCount, int candidateCount, int partyCount,
+                           int constituencyCount = 1) {
+    if (!directory.empty()) filesystem::create_directories(directory);
+    constituencyCount = max(1, constituencyCount);
+    
+    vector<string> codes;
+    ofstream list(dataFilePath(directory, "constituencies.txt"));
+    for (int k = 0; k < constituencyCount; k++) {
+        codes.push_back("NA-" + to_string(k + 1));
+        list << codes[k] << ",Constituency " << (k + 1) << '\n';
+    }
+    list.close();
+    
+    if (constituencyCount == 1) {
+        writeSyntheticVoters(dataFilePath(directory, constituencyTable("voters", codes[0]) + ".txt"), voterCount);
+    } else {
+        vector<ofstream> voterFiles;
+        for (const string& code : codes) {
+            voterFiles.emplace_back(dataFilePath(directory, constituencyTable("voters", code) + ".txt"));
+        }
+        for (long long i = 0; i < voterCount; i++) {
+            Voter voter("user" + to_string(i), "pass" + to_string(i), "Voter Number " + to_string(i),
+                        to_string(10001 + i), makeSyntheticCnic(i));
+            voterFiles[i % constituencyCount] << voter.toString() << '\n';
+        }
+    }
+    
+    vector<Party> parties;
+    for (int p = 0; p < partyCount; p++) {
+        parties.push_back(Party(to_string(201 + p), "Party " + to_string(p), "Symbol" + to_string(p),
+                                "Synthetic manifesto of party " + to_string(p)));
+    }
+    vector<vector<Candidate>> candidates(constituencyCount);
+    for (int c = 0; c < candidateCount; c++) {
+        string id = to_string(101 + c);
+        string cnic = makeSyntheticCnic(voterCount + c);
+        if (partyCount == 0 || c % 5 == 0) {
+            candidates[c % constituencyCount].push_back(Candidate(id, "Candidate " + id, cnic, 
+                                                                  "Independent synthetic manifesto"));
+        } else {
+            Party& party = parties[c % partyCount];
+            candidates[c % constituencyCount].push_back(Candidate(id, "Candidate " + id, cnic, party.getId(), 
+                                                                  "Party synthetic manifesto"));
+            party.addCandidate(id);
+        }
+    }
+    for (int k = 0; k < constituencyCount; k++) {
+        FileHandler<Candidate>::saveToFile(candidates[k], 
+                                           dataFilePath(directory, constituencyTable("candidates", codes[k]) + ".txt"));
+    }
+    FileHandler<Party>::saveToFile(parties, dataFilePath(directory, "parties.txt"));
+}
+
+// Collects per-operation latencies and prints percentiles and throughput
+class LatencyRecorder {
+private:
+    string operation;
+    vector<double> samples; // Microseconds
+    double totalSeconds;
+
+public:
+    LatencyRecorder(const string& op) : operation(op), totalSeconds(0) {}
+    
+    // Time one call of 'task'
+    template<typename Task>
+    void measure(Task task) {
+        auto start = chrono::steady_clock::now();
+        task();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        samples.push_back(seconds * 1e6);
+        totalSeconds += seconds;
+    }
+    
+    void add(double microseconds) {
+        samples.push_back(microseconds);
+        totalSeconds += microseconds / 1e6;
+    }
+    
+    // Combine the samples of another recorder (e.g. one per thread)
+    void merge(const LatencyRecorder& other) {
+        samples.insert(samples.end(), other.samples.begin(), other.samples.end());
+        totalSeconds += other.totalSeconds;
+    }
+    
+    size_t count() const { return samples.size(); }
+    
+    double percentile(double p) {
+        if (samples.empty()) return 0;
+        size_t rank = (size_t)(p / 100.0 * (samples.size() - 1) + 0.5);
+        nth_element(samples.begin(), samples.begin() + rank, samples.end());
+        return samples[rank];
+    }
+    
+    static void printHeader() {
+        cout << left << setw(22) << "Operation" << right << setw(9) << "Samples" 
+             << setw(12) << "p50 (us)" << setw(12) << "p95 (us)" << setw(12) << "p99 (us)" 
+             << setw(12) << "max (us)" << setw(14) << "items/sec" << endl;
+        cout << string(93, '-') << endl;
+    }
+    
+    // 'itemsPerSample' turns e.g. one file load into rows per second
+    void print(double itemsPerSample = 1) {
+        double p50 = percentile(50), p95 = percentile(95), p99 = percentile(99), p100 = percentile(100);
+        cout << left << setw(22) << operation << right << setw(9) << samples.size() << fixed << setprecision(1)
+             << setw(12) << p50 << setw(12) << p95 << setw(12) << p99 << setw(12) << p100
+             << setw(14) << setprecision(0) 
+             << (totalSeconds > 0 ? samples.size() * itemsPerSample / totalSeconds : 0) << endl;
+    }
+};
+
+// Benchmark suite: for every voter-roll size, generate a synthetic election
+// and time loading, saving, login, CNIC checks, voting and reporting
+void runBenchmarkSuite(const vector<long long>& sizes) {
+    for (long long voterCount : sizes) {
+        const string directory = "bench_data";
+        const int candidateCount = 20 + (int)(voterCount / 50000), partyCount = 10;
+        const int sampleCount = (int)min(voterCount, 100000LL);
+        
+        cout << "\n=== " << voterCount << " voters, " << candidateCount << " candidates, " 
+             << partyCount << " parties ===" << endl;
+        filesystem::remove_all(directory);
+        generateSyntheticData(directory, voterCount, candidateCount, partyCount);
+        LatencyRecorder::printHeader();
+        
+        // Whole-file operations report rows/sec, single operations ops/sec
+        {
+            LatencyRecorder load("loadFromFile"), loadParallel("loadFromFileParallel"), save("saveToFile");
+            vector<Voter> rows;
+            string voterFile = dataFilePath(directory, constituencyTable("voters", DEFAULT_CONSTITUENCY) + ".txt");
+            for (int run = 0; run < 3; run++) {
+                load.measure([&]() { FileHandler<Voter>::loadFromFile(rows, voterFile); });
+                loadParallel.measure([&]() { FileHandler<Voter>::loadFromFileParallel(rows, voterFile); });
+                save.measure([&]() { FileHandler<Voter>::saveToFile(rows, dataFilePath(directory, "voters_copy.txt")); });
+            }
+            load.print((double)voterCount);
+            loadParallel.print((double)voterCount);
+            save.print((double)voterCount);
+            remove(dataFilePath(directory, "voters_copy.txt").c_str());
+        }
+        
+        SystemOptions options;
+        options.dataDirectory = directory;
+        options.saveIntervalMs = 0; // Saves below are measured explicitly
+        LatencyRecorder startup("VotingSystem startup");
+        unique_ptr<VotingSystem> system;
+        startup.measure([&]() { system.reset(new VotingSystem(options)); });
+        startup.print((double)voterCount);
+        
+        mt19937 random(42);
+        uniform_int_distribution<long long> anyVoter(0, voterCount - 1);
+        
+        LatencyRecorder login("login");
+        Voter sessionVoter;
+        for (int i = 0; i < sampleCount; i++) {
+            long long v = anyVoter(random);
+            login.measure([&]() { system->authenticate("user" + to_string(v), "pass" + to_string(v), sessionVoter); });
+        }
+        login.print();
+        
+        // Half of the lookups hit an existing CNIC, half miss
+        LatencyRecorder cnic("cnicExists");
+        for (int i = 0; i < sampleCount; i++) {
+            string value = makeSyntheticCnic(i % 2 == 0 ? anyVoter(random) : voterCount + candidateCount + i);
+            cnic.measure([&]() { system->cnicExists(value); });
+        }
+        cnic.print();
+        
+        // New registrations with fresh CNICs (the exact check is only needed on a filter hit)
+        LatencyRecorder registration("registerVoter");
+        for (int i = 0; i < sampleCount; i++) {
+            string name = "bench" + to_string(i);
+            string value = makeSyntheticCnic(voterCount + candidateCount + sampleCount + i);
+            registration.measure([&]() { system->registerVoterAccount(name, "pw", name, value); });
+        }
+        registration.print();
+        system->printCnicFilterStats();
+        
+        system->setElectionWindow(time(0) - 60, time(0) + 3600);
+        LatencyRecorder vote("castVote");
+        for (int i = 0; i < sampleCount; i++) {
+            string voterId = to_string(10001 + i), candidateId = to_string(101 + i % candidateCount);
+            vote.measure([&]() { system->submitVote(voterId, candidateId); });
+        }
+        vote.print();
+        
+        // Reports need a finished election; console output is discarded
+        system->setElectionWindow(time(0) - 7200, time(0) - 3600);
+        LatencyRecorder report("generateElectionReport");
+        ostringstream discard;
+        streambuf* console = cout.rdbuf(discard.rdbuf());
+        for (int run = 0; run < 5; run++) {
+            report.measure([&]() { system->generateElectionReport(); });
+            discard.str("");
+        }
+        cout.rdbuf(console);
+        report.print();
+        
+        LatencyRecorder saveAll("saveData");
+        saveAll.measure([&]() { system->saveData(); });
+        saveAll.print((double)voterCount);
+        
+        // Later saves rewrite only the segments holding changed records
+        system->setElectionWindow(time(0) - 60, time(0) + 3600);
+        uniform_int_distribution<long long> anyRegistered(0, voterCount + sampleCount - 1);
+        for (int changes : {1, 10, 100}) {
+            LatencyRecorder saveChanged("saveData (" + to_string(changes) + (changes == 1 ? " vote)" : " votes)"));
+            for (int run = 0; run < 3; run++) {
+                // Voters anywhere in the roll that have not voted yet
+                for (int i = 0, tries = 0; i < changes && tries < 100 * changes; tries++) {
+                    string voterId = to_string(10001 + anyRegistered(random));
+                    if (system->submitVote(voterId, to_string(101 + i % candidateCount)) == VoteResult::SUCCESS) i++;
+                }
+                saveChanged.measure([&]() { system->saveData(); });
+            }
+            saveChanged.print();
+        }
+        
+        // Votes while another thread keeps saving: they wait for the
+        // changed segments to be captured, not for the disk writes
+        LatencyRecorder voteDuringSave("castVote during saveData");
+        atomic<bool> voting(true);
+        thread saver([&]() { while (voting) system->saveData(); });
+        for (int i = 0; i < sampleCount; i++) {
+            string voterId = to_string(10001 + anyRegistered(random)), candidateId = to_string(101 + i % candidateCount);
+            voteDuringSave.measure([&]() { system->submitVote(voterId, candidateId); });
+        }
+        voting = false;
+        saver.join();
+        voteDuringSave.print();
+        system.reset();
+        
+        // Lazy mode pages voters in through the index files saved above
+        options.lazyVoters = true;
+        LatencyRecorder firstLogin("lazy startup + login");
+        firstLogin.measure([&]() {
+            system.reset(new VotingSystem(options));
+            Voter sessionVoter;
+            system->authenticate("user0", "pass0", sessionVoter);
+        });
+        firstLogin.print();
+        system.reset();
+        filesystem::remove_all(directory);
+    }
+}
+
+/*
+ * Load simulator: scripted voter sessions arriving at a fixed rate
+ * (Poisson arrivals) and served by a pool of terminal threads. Each
+ * script step calls the same VotingSystem operation as its menu entry.
+ */
+enum class SessionAction { REGISTER, LOGIN, VIEW_CANDIDATES, CAST_VOTE, CHECK_STATUS };
+
+const char* sessionActionName(SessionAction action) {
+    switch (action) {
+        case SessionAction::REGISTER: return "register";
+        case SessionAction::LOGIN: return "login";
+        case SessionAction::VIEW_CANDIDATES: return "view_candidates";
+        case SessionAction::CAST_VOTE: return "cast_vote";
+        case SessionAction::CHECK_STATUS: return "check_status";
+    }
+    return "";
+}
+
+// Read a session script (one action per line, '#' starts a comment);
+// without a file the default election-day session is used
+vector<SessionAction> loadSessionScript(const string& filename) {
+    vector<SessionAction> script;
+    if (filename.empty()) {
+        return {SessionAction::REGISTER, SessionAction::LOGIN, SessionAction::VIEW_CANDIDATES,
+                SessionAction::CAST_VOTE, SessionAction::CHECK_STATUS};
+    }
+    ifstream file(filename);
+    string line;
+    while (getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        line.erase(remove_if(line.begin(), line.end(), ::isspace), line.end());
+        if (line.empty()) continue;
+        bool known = false;
+        for (int a = 0; a <= (int)SessionAction::CHECK_STATUS; a++) {
+            if (line == sessionActionName((SessionAction)a)) {
+                script.push_back((SessionAction)a);
+                known = true;
+            }
+        }
+        if (!known) cout << "Ignoring unknown script action: " << line << endl;
+    }
+    return script;
+}
+
+void runLoadSimulation(int sessionCount, const vector<double>& rates, unsigned terminals, const string& scriptFile) {
+    const string directory = "sim_data";
+    const int candidateCount = 20;
+    vector<SessionAction> script = loadSessionScript(scriptFile);
+    if (script.empty()) {
+        cout << "Session script is empty." << endl;
+        return;
+    }
+    
+    filesystem::remove_all(directory);
+    generateSyntheticData(directory, 1000, candidateCount, 5);
+    SystemOptions options;
+    options.dataDirectory = directory;
+    unique_ptr<VotingSystem> system(new VotingSystem(options));
+    system->setElectionWindow(time(0) - 60, time(0) + 24 * 3600);
+    
+    cout << "Script:";
+    for (SessionAction action : script) cout << " " << sessionActionName(action);
+    cout << "\nSessions per rate: " << sessionCount << ", terminals: " << terminals << endl;
+    
+    long long nextIdentity = 0; // Keeps simulated usernames and CNICs unique across runs
+    double baselineP99 = 0, saturationRate = 0;
+    bool saturated = false;
+    
+    for (double rate : rates) {
+        // Poisson arrivals: exponential gaps with mean 1/rate
+        mt19937 random(7);
+        exponential_distribution<double> gap(rate);
+        auto start = chrono::steady_clock::now() + chrono::milliseconds(20);
+        vector<chrono::steady_clock::time_point> arrival(sessionCount);
+        double offset = 0;
+        for (int i = 0; i < sessionCount; i++) {
+            offset += gap(random);
+            arrival[i] = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(offset));
+        }
+        
+        vector<vector<LatencyRecorder>> actionLatency(terminals);
+        vector<LatencyRecorder> sessionLatency(terminals, LatencyRecorder("session"));
+        atomic<int> nextSession(0);
+        long long identityBase = nextIdentity;
+        nextIdentity += sessionCount;
+        
+        auto terminal = [&](unsigned t) {
+            for (int a = 0; a <= (int)SessionAction::CHECK_STATUS; a++) {
+                actionLatency[t].push_back(LatencyRecorder(sessionActionName((SessionAction)a)));
+            }
+            ostringstream screen; // Menu output goes here instead of the console
+            int i;
+            while ((i = nextSession.fetch_add(1)) < sessionCount) {
+                this_thread::sleep_until(arrival[i]);
+                long long k = identityBase + i;
+                string username = "sim" + to_string(k), password = "simpass" + to_string(k);
+                string voterId;
+                
+                for (SessionAction action : script) {
+                    auto actionStart = chrono::steady_clock::now();
+                    switch (action) {
+                        case SessionAction::REGISTER:
+                            system->registerVoterAccount(username, password, "Simulated Voter " + to_string(k),
+                                                        makeSyntheticCnic(5000000000LL + k));
+                            break;
+                        case SessionAction::LOGIN:
+                            voterId = system->loginVoter(username, password);
+                            break;
+                        case SessionAction::VIEW_CANDIDATES:
+                            system->viewAllCandidatesForVoter(voterId, screen);
+                            break;
+                        case SessionAction::CAST_VOTE:
+                            system->submitVote(voterId, to_string(101 + k % candidateCount));
+                            break;
+                        case SessionAction::CHECK_STATUS:
+                            system->viewVotingStatus(voterId, screen);
+                            break;
+                    }
+                    auto now = chrono::steady_clock::now();
+                    actionLatency[t][(int)action].add(chrono::duration<double, micro>(now - actionStart).count());
+                    screen.str("");
+                }
+                // End-to-end: from the session's arrival, including time spent queued
+                sessionLatency[t].add(chrono::duration<double, micro>(chrono::steady_clock::now() - arrival[i]).count());
+            }
+        };
+        
+        vector<thread> pool;
+        for (unsigned t = 0; t < terminals; t++) {
+            pool.emplace_back(terminal, t);
+        }
+        for (auto& worker : pool) {
+            worker.join();
+        }
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double achieved = sessionCount / elapsed;
+        
+        cout << "\n--- Offered " << fixed << setprecision(0) << rate << " sessions/sec, achieved " 
+             << achieved << " sessions/sec ---" << endl;
+        LatencyRecorder::printHeader();
+        for (int a = 0; a <= (int)SessionAction::CHECK_STATUS; a++) {
+            LatencyRecorder merged(sessionActionName((SessionAction)a));
+            for (unsigned t = 0; t < terminals; t++) merged.merge(actionLatency[t][a]);
+            if (merged.count() > 0) merged.print();
+        }
+        LatencyRecorder session("session (end-to-end)");
+        for (unsigned t = 0; t < terminals; t++) session.merge(sessionLatency[t]);
+        double p99 = session.percentile(99);
+        session.print();
+        
+        // Saturated once throughput falls behind the offered load or the
+        // tail latency explodes compared with the lightest load
+        if (baselineP99 == 0) baselineP99 = max(p99, 1000.0);
+        if (!saturated && (achieved < 0.9 * rate || p99 > 10 * baselineP99)) {
+            saturated = true;
+        } else if (!saturated) {
+            saturationRate = achieved;
+        }
+    }
+    
+    cout << endl;
+    if (saturated) {
+        cout << "Saturation point: about " << fixed << setprecision(0) << saturationRate 
+             << " sessions/sec (highest rate served without queueing)" << endl;
+    } else {
+        cout << "Not saturated at the highest offered rate." << endl;
+    }
+    system.reset(); // Saves into the directory before it is removed
+    filesystem::remove_all(directory);
+}
+
+// Compare the single-threaded and the parallel text loader
+void runLoadBenchmark(long long rows, unsigned threads) {
+    const string filename = "bench_voters.txt";
+    cout << "Generating " << rows << " voters..." << endl;
+    writeSyntheticVoters(filename, rows);
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    
+    auto timeLoad = [&](bool parallel, unsigned threadCount) {
+        vector<Voter> data;
+        auto start = chrono::steady_clock::now();
+        if (parallel) {
+            FileHandler<Voter>::loadFromFileParallel(data, filename, threadCount);
+        } else {
+            FileHandler<Voter>::loadFromFile(data, filename);
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if ((long long)data.size() != rows) cout << "  WARNING: loaded " << data.size() << " rows" << endl;
+        return ms;
+    };
+    
+    double baseline = timeLoad(false, 1);
+    cout << left << setw(24) << "loadFromFile" << fixed << setprecision(1) << baseline << " ms" << endl;
+    for (unsigned t : threadCountSteps(threads)) {
+        double ms = timeLoad(true, t);
+        cout << left << setw(24) << ("parallel, " + to_string(t) + " threads") 
+             << fixed << setprecision(1) << ms << " ms  (speedup " << setprecision(2) 
+             << baseline / ms << "x)" << endl;
+    }
+    remove(filename.c_str());
+}
+
+// Memory per voter of the columnar VoterStore against the previous layout
+// (a DataManager<Voter> of Voter objects with id, cnic and username
+// indexes). Both are filled with the same synthetic voters.
+void runMemoryBenchmark(long long rows) {
+    auto makeVoter = [](long long i) {
+        return Voter("user" + to_string(i), "pass" + to_string(i), "Voter Number " + to_string(i),
+                     to_string(10001 + i), makeSyntheticCnic(i));
+    };
+    auto report = [&](const string& label, size_t before, size_t after, size_t counted) {
+        double rssPerVoter = after > before ? double(after - before) / rows : 0;
+        cout << left << setw(28) << label << fixed << setprecision(1) << setw(18) << rssPerVoter;
+        if (counted > 0) cout << double(counted) / rows;
+        else cout << "-";
+        cout << endl;
+        return rssPerVoter;
+    };
+    
+    cout << "Voters: " << rows << endl;
+    cout << left << setw(28) << "Layout" << setw(18) << "RSS bytes/voter" << "Counted bytes/voter" << endl;
+    cout << string(66, '-') << endl;
+    
+    double columnar = 0, objects = 0;
+    {
+        size_t before = residentBytes();
+        DataManager<Candidate> candidates;
+        VoterStore store(&candidates);
+        for (long long i = 0; i < rows; i++) store.addData(makeVoter(i));
+        store.shrinkToFit();
+        columnar = report("VoterStore (columns)", before, residentBytes(), store.memoryUsage());
+    }
+    {
+        size_t before = residentBytes();
+        DataManager<Voter> voters;
+        voters.addIndex("id", &Voter::getId);
+        voters.addIndex("cnic", &Voter::getCnic);
+        voters.addIndex("username", &Voter::getUsername);
+        for (long long i = 0; i < rows; i++) voters.addData(makeVoter(i));
+        objects = report("DataManager<Voter>", before, residentBytes(), 0);
+    }
+    if (columnar > 0) {
+        cout << "Reduction: " << fixed << setprecision(1) << objects / columnar << "x less memory per voter" << endl;
+    }
+}
+
+// Discards output, counting its bytes (the screens of benchmark sessions)
+class CountingBuffer : public streambuf {
+private:
+    long long bytes = 0;
+
+protected:
+    int overflow(int ch) override {
+        bytes++;
+        return traits_type::not_eof(ch);
+    }
+    streamsize xsputn(const char*, streamsize count) override {
+        bytes += count;
+        return count;
+    }
+
+public:
+    long long getBytes() const { return bytes; }
+};
+
+// Thousands of console sessions on one thread. Nine scripted voter
+// sessions (login, candidates, vote, status) run for every admin session
+// (login, register a voter, election status). All sessions are first
+// brought to their menu and left suspended to measure their memory,
+// then fed one line at a time, round robin, until every one has ended.
+void runSessionBenchmark(int sessionCount) {
+    const string directory = "bench_sessions_data";
+    filesystem::remove_all(directory);
+    generateSyntheticData(directory, sessionCount, 20, 5);
+    {
+        SystemOptions options;
+        options.dataDirectory = directory;
+        options.saveIntervalMs = 0;
+        VotingSystem system(options);
+        system.setElectionWindow(time(0) - 60, time(0) + 3600);
+        
+        vector<string> scripts(sessionCount);
+        int voterSessions = 0;
+        for (int i = 0; i < sessionCount; i++) {
+            string n = to_string(i);
+            if (i % 10 == 9) {
+                scripts[i] = "1\nadmin\nadmin123\n4\nnewvoter" + n + "\npassword" + n + "\nNew Voter " + n + "\n" + 
+                             makeSyntheticCnic(sessionCount + 100 + i) + "\n7\n12\n4\n";
+            } else {
+                vector<BallotEntry> ballot;
+                system.getBallot(to_string(10001 + i), ballot);
+                scripts[i] = "2\nuser" + n + "\npass" + n + "\n1\n3\n" + ballot[i % ballot.size()].id + "\ny\n4\n5\n4\n";
+                voterSessions++;
+            }
+        }
+        
+        CountingBuffer screen;
+        ostream out(&screen);
+        vector<unique_ptr<ConsoleSession>> sessions;
+        vector<size_t> position(sessionCount, 0); // Script bytes fed to each session
+        auto feedLines = [&](int i, int lineCount) {
+            int fed = 0;
+            while (fed < lineCount && position[i] < scripts[i].size()) {
+                size_t end = scripts[i].find('\n', position[i]) + 1;
+                sessions[i]->feed(string_view(scripts[i]).substr(position[i], end - position[i]));
+                position[i] = end;
+                fed++;
+            }
+            return fed;
+        };
+        
+        // Log every session in and leave it waiting at its menu
+        size_t residentBefore = residentBytes();
+        long long framesBefore = sessionFrameBytes;
+        sessions.reserve(sessionCount);
+        for (int i = 0; i < sessionCount; i++) {
+            sessions.push_back(make_unique<ConsoleSession>(out));
+            sessions[i]->start(system.runSession(*sessions[i]));
+            feedLines(i, 3); // Menu choice, username, password
+        }
+        double frameBytes = double(sessionFrameBytes - framesBefore) / sessionCount;
+        double stateBytes = sizeof(ConsoleSession);
+        for (const auto& session : sessions) stateBytes += double(session->bufferedBytes()) / sessionCount;
+        size_t residentAfter = residentBytes();
+        
+        cout << "\n=== " << sessionCount << " sessions on one thread (" << voterSessions << " voters, " 
+             << sessionCount - voterSessions << " admins) ===" << endl;
+        cout << "Suspended at their menu:" << endl;
+        cout << fixed << setprecision(0);
+        cout << "  Coroutine frames: " << frameBytes << " bytes/session" << endl;
+        cout << "  Session state:    " << stateBytes << " bytes/session" << endl;
+        cout << "  Resident growth:  " 
+             << (residentAfter > residentBefore ? double(residentAfter - residentBefore) / sessionCount : 0) 
+             << " bytes/session (includes the pages touched by the logins)" << endl;
+        
+        // Every session answers its next prompt in turn
+        auto start = chrono::steady_clock::now();
+        long long prompts = 0;
+        size_t active = sessionCount;
+        while (active > 0) {
+            active = 0;
+            for (int i = 0; i < sessionCount; i++) {
+                if (sessions[i]->finished()) continue;
+                int fed = feedLines(i, 1);
+                prompts += fed;
+                if (fed > 0 && !sessions[i]->finished()) active++;
+            }
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        
+        int voted = 0, registered = 0, ended = 0;
+        for (int i = 0; i < sessionCount; i++) {
+            ended += sessions[i]->finished();
+            if (i % 10 == 9) {
+                registered += system.usernameExists("newvoter" + to_string(i));
+            } else {
+                VoterStatus status;
+                voted += system.getVoterStatus(to_string(10001 + i), status) && status.hasVoted;
+            }
+        }
+        cout << "Ran to completion:" << endl;
+        cout << "  " << prompts << " prompts answered in " << setprecision(2) << seconds << " s (" 
+             << setprecision(0) << prompts / seconds << " prompts/sec, " << sessionCount / seconds 
+             << " sessions/sec)" << endl;
+        cout << "  " << screen.getBytes() / 1024 << " KB of screen output" << endl;
+        cout << "  Sessions ended: " << ended << " of " << sessionCount << ", votes cast: " << voted << " of " 
+             << voterSessions << ", voters registered: " << registered << " of " << sessionCount - voterSessions 
+             << endl;
+    }
+    filesystem::remove_all(directory);
+}
+
+// The per-character check and packing the CNIC kernels replaced
+// (isdigit validation, then a second pass for the digits): the
+// baseline of --bench-cnic and the reference of --fuzz-cnic
+uint64_t parseCnicPrevious(string_view cnic) {
+    if (cnic.length() != 15 || cnic[5] != '-' || cnic[13] != '-') return INVALID_CNIC;
+    for (int i = 0; i < 15; i++) {
+        if (i != 5 && i != 13 && !isdigit((unsigned char)cnic[i])) return INVALID_CNIC;
+    }
+    char digits[13];
+    size_t count = 0;
+    for (char c : cnic) {
+        if (c != '-') digits[count++] = c;
+    }
+    uint64_t packed = 0;
+    from_chars(digits, digits + 13, packed);
+    return packed;
+}
+
+// Every kernel this processor runs
+vector<SimdKernel> availableSimdKernels() {
+    vector<SimdKernel> kernels = {SimdKernel::SCALAR};
+#ifdef X86_SIMD
+    kernels.push_back(SimdKernel::SSE2);
+    if (bestSimdKernel == SimdKernel::AVX2) kernels.push_back(SimdKernel::AVX2);
+#endif
+    return kernels;
+}
+
+// Throughput of the CNIC kernels on a synthetic roll extract with one
+// malformed CNIC in a hundred
+void runCnicBenchmark(long long count) {
+    mt19937_64 random(7);
+    string extract;
+    extract.reserve(count * 16);
+    for (long long i = 0; i < count; i++) {
+        string cnic = VoterStore::formatCnic(1000000000000ULL + random() % 9000000000000ULL);
+        if (random() % 100 == 0) cnic[random() % 15] = (char)(random() % 256);
+        extract += cnic;
+        extract += '\n';
+    }
+    vector<string_view> cnics(count);
+    for (long long i = 0; i < count; i++) cnics[i] = string_view(extract).substr(i * 16, 15);
+    vector<uint64_t> packed(count);
+    
+    cout << "CNICs: " << count << " (kernel chosen for this CPU: " << simdKernelName(bestSimdKernel) << ")" << endl;
+    cout << left << setw(30) << "Kernel" << right << setw(16) << "M CNICs/sec" << setw(12) << "Speedup" 
+         << setw(12) << "Valid" << endl;
+    cout << string(70, '-') << endl;
+    
+    // Best of three runs; the checksum proves every kernel got the same answers
+    double baseline = 0;
+    uint64_t expectedSum = 0;
+    auto measure = [&](const string& label, const function<void()>& run) {
+        double best = 1e30;
+        for (int r = 0; r < 3; r++) {
+            auto start = chrono::steady_clock::now();
+            run();
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        long long valid = 0;
+        uint64_t sum = 0;
+        for (uint64_t value : packed) {
+            if (value != INVALID_CNIC) valid++;
+            sum = sum * 31 + value;
+        }
+        double rate = count / best / 1e6;
+        if (baseline == 0) {
+            baseline = rate;
+            expectedSum = sum;
+        }
+        cout << left << setw(30) << label << right << fixed << setprecision(1) << setw(16) << rate 
+             << setw(11) << rate / baseline << "x" << setw(12) << valid 
+             << (sum == expectedSum ? "" : "  MISMATCH") << endl;
+    };
+    
+    measure("per-character loop (previous)", [&]() {
+        for (long long i = 0; i < count; i++) packed[i] = parseCnicPrevious(cnics[i]);
+    });
+    for (SimdKernel kernel : availableSimdKernels()) {
+        measure(string(simdKernelName(kernel)) + " kernel", [&]() { packCnics(cnics.data(), count, packed.data(), kernel); });
+    }
+}
+
+// Random, mutated and truncated CNICs through every kernel: each must
+// agree with the previous per-character check on every input. Returns
+// false on the first disagreement.
+bool runCnicFuzz(long long iterations, uint64_t seed) {
+    mt19937_64 random(seed);
+    const string nearMisses = string("/:-,. 09") + '\0' + "\x7f\x80\xb0\xff";
+    auto randomCnic = [&]() {
+        string cnic(15, '-');
+        for (int i = 0; i < 15; i++) {
+            if (i != 5 && i != 13) cnic[i] = (char)('0' + random() % 10);
+        }
+        return cnic;
+    };
+    auto makeCase = [&]() {
+        string cnic = randomCnic();
+        switch (random() % 6) {
+            case 0: break; // Valid
+            case 1: cnic[random() % 15] = (char)(random() % 256); break;
+            case 2: cnic[random() % 15] = nearMisses[random() % nearMisses.size()]; break;
+            case 3: { // Digits and hyphens of any length
+                cnic.assign(random() % 21, '0');
+                for (char& c : cnic) c = "0123456789-"[random() % 11];
+                break;
+            }
+            case 4: swap(cnic[random() % 15], cnic[random() % 15]); break;
+            case 5: // One byte too short or too long
+                if (random() % 2) cnic.pop_back();
+                else cnic.insert(cnic.begin() + random() % 16, (char)('0' + random() % 10));
+                break;
+        }
+        return cnic;
+    };
+    
+    vector<SimdKernel> kernels = availableSimdKernels();
+    long long checked = 0, valid = 0;
+    vector<string> cases;
+    vector<string_view> views;
+    vector<uint64_t> expected, packed;
+    while (checked < iterations) {
+        // Batches of every size exercise the two-at-a-time AVX2 loop and its tail
+        size_t batch = min<long long>(1 + random() % 4096, iterations - checked);
+        cases.resize(batch);
+        views.resize(batch);
+        expected.resize(batch);
+        packed.resize(batch);
+        for (size_t i = 0; i < batch; i++) {
+            cases[i] = makeCase();
+            views[i] = cases[i];
+            expected[i] = parseCnicPrevious(cases[i]);
+            if (expected[i] != INVALID_CNIC) valid++;
+        }
+        auto compare = [&](const char* kernel) {
+            for (size_t i = 0; i < batch; i++) {
+                if (packed[i] != expected[i]) {
+                    cout << "MISMATCH (" << kernel << "): input bytes";
+                    for (unsigned char c : cases[i]) cout << " " << (int)c;
+                    cout << ", expected " << expected[i] << ", got " << packed[i] << endl;
+                    return false;
+                }
+            }
+            return true;
+        };
+        for (SimdKernel kernel : kernels) {
+            packCnics(views.data(), batch, packed.data(), kernel);
+            if (!compare(simdKernelName(kernel))) return false;
+        }
+        for (size_t i = 0; i < batch; i++) packed[i] = parseCnic(views[i]);
+        if (!compare("parseCnic")) return false;
+        checked += batch;
+    }
+    
+#ifndef _WIN32
+    // A CNIC that ends at the end of a readable page must not fault
+    long pageSize = sysconf(_SC_PAGESIZE);
+    char* pages = (char*)mmap(nullptr, pageSize * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages != MAP_FAILED) {
+        mprotect(pages + pageSize, pageSize, PROT_NONE);
+        string cnic = randomCnic();
+        char* last = pages + pageSize - cnic.size();
+        memcpy(last, cnic.data(), cnic.size());
+        string_view atEdge(last, cnic.size());
+        for (SimdKernel kernel : kernels) {
+            uint64_t result;
+            packCnics(&atEdge, 1, &result, kernel);
+            if (result != parseCnicPrevious(cnic)) {
+                cout << "MISMATCH (" << simdKernelName(kernel) << ") at a page boundary" << endl;
+                return false;
+            }
+        }
+        munmap(pages, pageSize * 2);
+    }
+#endif
+    
+    cout << "CNIC fuzz: " << checked << " inputs (" << valid << " valid, seed " << seed << ") through";
+    for (SimdKernel kernel : kernels) cout << " " << simdKernelName(kernel);
+    cout << ": all kernels agree with the per-character check" << endl;
+    return true;
+}
+
+// Throughput of the delimiter scanner on a synthetic voters.txt: the
+// structural index alone, the index plus walking every field, and
+// building the voter columns on one thread - each against the previous
+// line-by-line tokenizer. Checksums prove every path saw the same fields.
+void runScanBenchmark(long long rows) {
+    const string filename = "bench_scan_voters.txt";
+    cout << "Generating " << rows << " voters..." << endl;
+    writeSyntheticVoters(filename, rows);
+    string buffer;
+    readWholeFile(filename, buffer);
+    remove(filename.c_str());
+    double gigabytes = buffer.size() / 1e9;
+    
+    cout << "voters.txt: " << rows << " rows, " << fixed << setprecision(1) << buffer.size() / 1e6 
+         << " MB (kernel chosen for this CPU: " << simdKernelName(bestSimdKernel) << ")" << endl;
+    cout << left << setw(34) << "Path" << right << setw(12) << "GB/sec" << setw(16) << "M rows/sec" 
+         << setw(12) << "Speedup" << endl;
+    cout << string(74, '-') << endl;
+    
+    // Best of three runs; 'checksum' (taken after the runs) proves every
+    // path saw the same fields
+    double baseline = 0;
+    uint64_t expectedSum = 0;
+    auto measure = [&](const string& label, const function<void()>& run, const function<uint64_t()>& checksum) {
+        double best = 1e30;
+        for (int r = 0; r < 3; r++) {
+            auto start = chrono::steady_clock::now();
+            run();
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+        uint64_t sum = checksum();
+        if (baseline == 0) {
+            baseline = best;
+            expectedSum = sum;
+        }
+        cout << left << setw(34) << label << right << fixed << setprecision(2) << setw(12) << gigabytes / best 
+             << setw(16) << rows / best / 1e6 << setw(11) << setprecision(1) << baseline / best << "x" 
+             << (sum != expectedSum ? "  MISMATCH" : "") << endl;
+    };
+    
+    // Every field's offset and length (a plain sum, so the checksum costs
+    // less than finding the fields)
+    uint64_t fieldSum = 0;
+    auto addField = [&](string_view field) {
+        fieldSum += ((uint64_t)(field.data() - buffer.data()) << 8) ^ field.size();
+    };
+    auto takeFieldSum = [&]() { return exchange(fieldSum, 0); };
+    measure("fields: lines + tokenizer (previous)", [&]() {
+        fieldSum = 0;
+        forEachLine(buffer, 0, buffer.size(), [&](string_view line) {
+            FieldTokenizer fields(line);
+            while (fields.hasMore()) addField(fields.next());
+        });
+    }, takeFieldSum);
+    for (SimdKernel kernel : availableSimdKernels()) {
+        measure(string("fields: ") + simdKernelName(kernel) + " index", [&]() {
+            fieldSum = 0;
+            forEachRecord(buffer, 0, buffer.size(), [&](IndexedFields& fields) {
+                while (fields.hasMore()) addField(fields.next());
+            }, kernel);
+        }, takeFieldSum);
+    }
+    
+    // The index alone (speedups against the previous tokenizer); every
+    // kernel must find the same number of delimiters
+    vector<uint32_t> positions(SCAN_WINDOW_BYTES + 8);
+    uint64_t delimiters = 0;
+    expectedSum = (uint64_t)count_if(buffer.begin(), buffer.end(), 
+                                     [](char c) { return c == ',' || c == ';' || c == '\n'; });
+    for (SimdKernel kernel : availableSimdKernels()) {
+        measure(string("index only: ") + simdKernelName(kernel), [&]() {
+            delimiters = 0;
+            for (size_t begin = 0; begin < buffer.size(); begin += SCAN_WINDOW_BYTES) {
+                size_t length = min(SCAN_WINDOW_BYTES, buffer.size() - begin);
+                delimiters += scanDelimiters(buffer.data() + begin, length, positions.data(), kernel);
+            }
+        }, [&]() { return delimiters; });
+    }
+    
+    // The voter columns built on one thread; the checksum covers every column
+    VoterStore store;
+    auto storeSum = [&]() {
+        uint64_t sum = store.size();
+        for (uint32_t p = 0; p < store.size(); p++) {
+            sum = sum * 31 + store.getNumericId(p);
+            sum = sum * 31 + hash<string>()(store.getCnic(p));
+            sum = sum * 31 + hash<string_view>()(store.getUsernameView(p)) + store.getNameView(p).size();
+            sum = sum * 31 + hash<string_view>()(store.getPasswordView(p)) + store.getHasVoted(p);
+        }
+        return sum;
+    };
+    baseline = 0;
+    measure("voter columns: tokenizer (previous)", [&]() {
+        store.clearData();
+        forEachLine(buffer, 0, buffer.size(), [&](string_view line) { store.appendRecord(line); });
+    }, storeSum);
+    measure(string("voter columns: ") + simdKernelName(bestSimdKernel) + " index", [&]() {
+        store.clearData();
+        forEachRecord(buffer, 0, buffer.size(), [&](IndexedFields& fields) { store.appendRecord(fields); });
+    }, storeSum);
+}
+
+// A national race: every candidate stands in one constituency and each
+// voter votes for a random one. Times the report (screen discarded, the
+// four files written) against a stable sort of the candidate positions
+// by votes, the step the live leaderboards spare the report.
+void runReportBenchmark(int candidateCount) {
+    const string directory = "bench_report_data";
+    filesystem::remove_all(directory);
+    long long voterCount = max(1000LL, 5LL * candidateCount);
+    cout << "Generating " << voterCount << " voters and " << candidateCount << " candidates..." << endl;
+    generateSyntheticData(directory, voterCount, candidateCount, 10, 1);
+    
+    SystemOptions options;
+    options.dataDirectory = directory;
+    options.saveIntervalMs = 0;
+    options.metricsIntervalMs = 0;
+    {
+        VotingSystem system(options);
+        system.setElectionWindow(time(0) - 60, time(0) + 3600);
+        vector<int> votes(candidateCount, 0);
+        mt19937 rng(12345);
+        for (long long v = 0; v < voterCount; v++) {
+            int candidate = (int)(rng() % candidateCount);
+            if (system.submitVote(to_string(10001 + v), to_string(101 + candidate)) == VoteResult::SUCCESS) {
+                votes[candidate]++;
+            }
+        }
+        system.setElectionWindow(time(0) - 7200, time(0) - 1);
+        
+        // Best of three runs, in milliseconds
+        auto best = [](const function<void()>& run) {
+            double fastest = 1e30;
+            for (int r = 0; r < 3; r++) {
+                auto start = chrono::steady_clock::now();
+                run();
+                fastest = min(fastest, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+            }
+            return fastest;
+        };
+        
+        double sortMs = best([&]() {
+            vector<int> order(votes.size());
+            for (size_t i = 0; i < order.size(); i++) order[i] = (int)i;
+            stable_sort(order.begin(), order.end(), [&](int a, int b) { return votes[a] > votes[b]; });
+        });
+        double tallyMs = best([&]() {
+            ElectionTally outcome;
+            system.tally(outcome);
+        });
+        CountingBuffer screenBytes;
+        ostream screen(&screenBytes);
+        double reportMs = best([&]() { system.generateElectionReport(screen); });
+        
+        cout << "\n=== Election report: " << candidateCount << " candidates in one constituency, " 
+             << voterCount << " voters ===" << endl;
+        cout << left << setw(44) << "Step" << right << setw(12) << "ms" << endl;
+        cout << string(56, '-') << endl;
+        cout << fixed << setprecision(2);
+        cout << left << setw(44) << "stable_sort of the candidates by votes" << right << setw(12) << sortMs << endl;
+        cout << left << setw(44) << "tally (rankings from the leaderboards)" << right << setw(12) << tallyMs << endl;
+        cout << left << setw(44) << "report: screen + txt + csv + json" << right << setw(12) << reportMs << endl;
+        cout << "Output per report: screen " << setprecision(1) << screenBytes.getBytes() / 3 / 1e6 << " MB";
+        for (const char* file : {"election_report.txt", "election_report.csv", "election_report_parties.csv", 
+                                 "election_report.json"}) {
+            cout << ", " << file << " " << filesystem::file_size(dataFilePath(directory, file)) / 1e6 << " MB";
+        }
+        cout << endl;
+    }
+    filesystem::remove_all(directory);
+}
+
+// Multi-threaded voting stress test. Every voter submits the same ballot
+// twice from different threads; afterwards each tally must be exact:
+// one accepted vote per voter, every duplicate rejected, and candidate
+// and party totals equal to the ballots that were cast.
+bool runVoteStressTest(int voterCount, unsigned maxThreads) {
+    const int candidateCount = 50, partyCount = 5;
+    const string directory = "stress_data";
+    if (maxThreads == 0) maxThreads = max(1u, thread::hardware_concurrency());
+    bool allExact = true;
+    
+    cout << left << setw(10) << "Threads" << setw(16) << "Votes/sec" << setw(16) << "Attempts/sec" 
+         << "Tallies" << endl;
+    cout << string(50, '-') << endl;
+    
+    for (unsigned threads : threadCountSteps(maxThreads)) {
+        filesystem::remove_all(directory);
+        filesystem::create_directories(directory);
+        {
+            SystemOptions options;
+            options.dataDirectory = directory;
+            ElectionEngine system(options);
+            
+            // Synthetic election: every fifth candidate is independent
+            for (int p = 0; p < partyCount; p++) {
+                system.addPartyRecord(Party(to_string(201 + p), "Party " + to_string(p), "S" + to_string(p),
+                                            "Stress test manifesto"));
+            }
+            for (int c = 0; c < candidateCount; c++) {
+                string id = to_string(101 + c);
+                string cnic = makeSyntheticCnic(1000000000LL + c);
+                if (c % 5 == 0) {
+                    system.addCandidateRecord(Candidate(id, "Candidate " + id, cnic, "Independent manifesto"));
+                } else {
+                    system.addCandidateRecord(Candidate(id, "Candidate " + id, cnic, 
+                                                        to_string(201 + c % partyCount), "Party manifesto"));
+                }
+            }
+            for (int v = 0; v < voterCount; v++) {
+                system.addVoterRecord(Voter("user" + to_string(v), "pass" + to_string(v), "Voter " + to_string(v),
+                                            to_string(10001 + v), makeSyntheticCnic(v)));
+            }
+            system.setElectionWindow(time(0) - 60, time(0) + 3600);
+            
+            // Voter v always votes for candidate v % candidateCount, twice
+            atomic<long long> accepted(0), rejected(0);
+            auto start = chrono::steady_clock::now();
+            vector<thread> pool;
+            for (unsigned t = 0; t < threads; t++) {
+                pool.emplace_back([&, t]() {
+                    for (long long k = t; k < 2LL * voterCount; k += threads) {
+                        int v = (int)(k % voterCount);
+                        VoteResult result = system.submitVote(to_string(10001 + v), 
+                                                              to_string(101 + v % candidateCount));
+                        if (result == VoteResult::SUCCESS) accepted++;
+                        else if (result == VoteResult::ALREADY_VOTED) rejected++;
+                    }
+                });
+            }
+            for (auto& worker : pool) {
+                worker.join();
+            }
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            
+            // Verify every tally against the expected counts
+            bool exact = (accepted == voterCount && rejected == voterCount);
+            vector<int> expectedParty(partyCount, 0);
+            for (int c = 0; c < candidateCount; c++) {
+                int expected = voterCount / candidateCount + (c < voterCount % candidateCount ? 1 : 0);
+                if (system.getCandidateVotes(to_string(101 + c)) != expected) exact = false;
+                if (c % 5 != 0) expectedParty[c % partyCount] += expected;
+            }
+            for (int p = 0; p < partyCount; p++) {
+                if (system.getPartyVotes(to_string(201 + p)) != expectedParty[p]) exact = false;
+            }
+            allExact = allExact && exact;
+            
+            cout << left << setw(10) << threads 
+                 << setw(16) << (long long)(accepted / seconds)
+                 << setw(16) << (long long)(2.0 * voterCount / seconds)
+                 << (exact ? "exact" : "MISMATCH") << endl;
+        }
+        filesystem::remove_all(directory);
+    }
+    return allExact;
+}
+
+// Rewrite every table in the other format: the data is loaded from
+// whichever files exist and saved again (a change of format rewrites
+// every segment)
+void convertDataFiles(SystemOptions options, bool toBinary) {
+    options.binarySnapshots = toBinary;
+    options.lazyVoters = false;
+    {
+        ElectionEngine system(options, &cout); // Saves when it goes out of scope
+    }
+    cout << "Data files in " << (options.dataDirectory.empty() ? "." : options.dataDirectory) 
+         << " saved as " << (toBinary ? "binary snapshots" : "text") << endl;
+}
+
+#ifdef __linux__
+/*
+ * ===================================================================
+ * KIOSK SERVER - one authoritative tally for the terminals of a machine
+ * Listens on a Unix domain socket. Every message is a frame: a 4-byte
+ * little-endian length, then a type byte and comma-separated fields.
+ *   Requests: 'L' username,password   log the connection in as a voter
+ *             'C'                     candidates on the voter's ballot
+ *             'V' candidateId         cast the voter's vote
+ *             'S'                     the voter's status
+ *   Replies:  'O' (success) or 'E' (error), then the result or message
+ * A non-blocking epoll loop does all socket I/O and answers lookups;
+ * votes go to a worker pool and their replies come back through an
+ * eventfd. Each connection is answered in order: while its vote is with
+ * the workers, its next requests are not read.
+ * ===================================================================
+ */
+const uint32_t MAX_FRAME_BYTES = 64 * 1024;
+
+void appendFrame(string& out, char type, string_view body) {
+    uint32_t length = (uint32_t)body.size() + 1;
+    for (int i = 0; i < 4; i++) out += (char)(length >> (8 * i));
+    out += type;
+    out.append(body);
+}
+
+// Next complete frame of buffer[offset...]; false if it has not fully
+// arrived yet. 'malformed' is set for an impossible length.
+bool nextFrame(const string& buffer, size_t& offset, char& type, string_view& body, bool& malformed) {
+    if (buffer.size() - offset < 4) return false;
+    uint32_t length = 0;
+    for (int i = 0; i < 4; i++) length |= (uint32_t)(unsigned char)buffer[offset + i] << (8 * i);
+    if (length == 0 || length > MAX_FRAME_BYTES) {
+        malformed = true;
+        return false;
+    }
+    if (buffer.size() - offset - 4 < length) return false;
+    type = buffer[offset + 4];
+    body = string_view(buffer).substr(offset + 5, length - 1);
+    offset += 4 + length;
+    return true;
+}
+
+// Let one process hold thousands of connections
+void raiseFileLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+bool fillSocketAddress(const string& path, sockaddr_un& address) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) return false;
+    memcpy(address.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+class KioskServer {
+private:
+    struct Connection {
+        uint64_t serial = 0;   // Tells a reused descriptor from the connection it replaced
+        string input, output;
+        size_t consumed = 0;   // Bytes of 'input' already answered
+        string voterId;        // Logged-in voter ("" = none)
+        bool busy = false;     // A vote is with the workers
+        uint32_t events = 0;   // Current epoll interest
+    };
+    struct VoteTask {
+        int fd;
+        uint64_t serial;
+        string voterId, candidateId;
+    };
+    struct VoteReply {
+        int fd;
+        uint64_t serial;
+        string frame;
+    };
+    static const size_t MAX_PENDING_OUTPUT = 1 << 20; // Stop reading a client that does not read
+    
+    ElectionEngine& engine;
+    string socketPath;
+    unsigned workerCount;
+    int listenFd, epollFd, wakeFd, stopFd;
+    unordered_map<int, Connection> connections;
+    uint64_t nextSerial;
+    
+    // Worker pool for votes
+    vector<thread> workers;
+    mutex queueMutex;
+    condition_variable taskReady;
+    deque<VoteTask> tasks;
+    vector<VoteReply> replies;
+    bool stopping;
+    
+    atomic<long long> requestCount{0};
+    
+    void watch(int fd, uint32_t events, bool add) {
+        epoll_event event = {};
+        event.events = events;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event);
+    }
+    
+    void closeConnection(int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        connections.erase(fd);
+    }
     
-    void addCandidate() {
-        cout << "\n=== ADD CANDIDATE ===" << endl;
-        
-        string id = generateCandidateId();
-        
-        string name = getValidatedString("Candidate Name: ", 2, 50);
-        string cnic = getValidatedCNIC("Candidate CNIC");
-        
-        // Check if CNIC already exists
-        if (cnicExists(cnic)) {
-            cout << "CNIC already registered in the system!" << endl;
-            return;
+    // Read while nothing is pending for the client, write while output waits
+    void updateInterest(int fd, Connection& connection) {
+        uint32_t events = 0;
+        if (!connection.busy && connection.output.size() < MAX_PENDING_OUTPUT) events |= EPOLLIN;
+        if (!connection.output.empty()) events |= EPOLLOUT;
+        if (events != connection.events) {
+            connection.events = events;
+            watch(fd, events, false);
         }
-        
-        cout << "\nCandidate Type:" << endl;
-        cout << "1. Independent Candidate" << endl;
-        cout << "2. Party Candidate" << endl;
-        int type = getValidatedInt("Select type: ", 1, 2);
-        
-        if (type == 1) {
-            // Independent candidate
-            string manifesto = getValidatedString("Personal Manifesto: ", 10, 200);
-            candidates.addData(Candidate(id, name, cnic, manifesto));
-            cout << "Independent candidate added successfully!" << endl;
-        } else {
-            // Party candidate
-            if (parties.getSize() == 0) {
-                cout << "No parties available. Please add a party first." << endl;
-                return;
-            }
-            
-            viewAllParties();
-            string partyId = getValidatedString("Enter Party ID: ");
-            
-            // Verify party exists
-            bool partyExists = false;
-            for (auto& party : parties.getAllData()) {
-                if (party.getId() == partyId) {
-                    partyExists = true;
-                    string manifesto = getValidatedString("Candidate Manifesto: ", 10, 200);
-                    candidates.addData(Candidate(id, name, cnic, partyId, manifesto));
-                    
-                    // Add candidate to party's candidate list
-                    party.addCandidate(id);
-                    cout << "Party candidate added successfully!" << endl;
-                    break;
-                }
-            }
-            
-            if (!partyExists) {
-                cout << "Invalid Party ID!" << endl;
+    }
+    
+    // Send what the socket takes; false if the connection was closed
+    bool flushOutput(int fd, Connection& connection) {
+        size_t sent = 0;
+        while (sent < connection.output.size()) {
+            ssize_t written = send(fd, connection.output.data() + sent, connection.output.size() - sent, MSG_NOSIGNAL);
+            if (written > 0) {
+                sent += written;
+            } else if (written < 0 && errno == EINTR) {
+                continue;
+            } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else {
+                closeConnection(fd);
+                return false;
             }
         }
+        connection.output.erase(0, sent);
+        updateInterest(fd, connection);
+        return true;
     }
     
-    void viewAllCandidates() {
-        cout << "\n=== ALL CANDIDATES ===" << endl;
-        if (candidates.getSize() == 0) {
-            cout << "No candidates registered." << endl;
+    void reply(Connection& connection, bool success, string_view body) {
+        appendFrame(connection.output, success ? 'O' : 'E', body);
+    }
+    
+    void handleRequest(int fd, Connection& connection, char type, string_view body) {
+        requestCount++;
+        if (type == 'L') {
+            FieldTokenizer fields(body);
+            string username(fields.next()), password(fields.next());
+            connection.voterId = engine.loginVoter(username, password);
+            if (connection.voterId.empty()) {
+                reply(connection, false, "Invalid credentials");
+            } else {
+                reply(connection, true, connection.voterId);
+            }
             return;
         }
-        
-        cout << left << setw(10) << "ID" << setw(20) << "Name" << setw(25) << "CNIC" 
-             << setw(12) << "Party/Type" << setw(10) << "Votes" << endl;
-        cout << string(75, '-') << endl;
-        
-        for (const auto& candidate : candidates.getAllData()) {
-            string partyInfo = candidate.getIsIndependent() ? "Independent" : candidate.getPartyId();
-            cout << left << setw(10) << candidate.getId()
-                 << setw(20) << candidate.getName()
-                 << setw(25) << candidate.getCnic()
-                 << setw(12) << partyInfo
-                 << setw(10) << candidate.getVotes() << endl;
+        if (type != 'C' && type != 'V' && type != 'S') {
+            reply(connection, false, "Unknown request");
+            return;
         }
-    }
-
-    void viewAllCandidatesForVoter() {
-        cout << "\n=== ALL CANDIDATES ===" << endl;
-        if (candidates.getSize() == 0) {
-            cout << "No candidates registered." << endl;
+        if (connection.voterId.empty()) {
+            reply(connection, false, "Not logged in");
             return;
         }
-        
-        cout << left << setw(10) << "ID" << setw(20) << "Name" << setw(25) << "CNIC" 
-             << setw(12) << "Party/Type" << endl;
-        cout << string(75, '-') << endl;
-        
-        for (const auto& candidate : candidates.getAllData()) {
-            string partyInfo = candidate.getIsIndependent() ? "Independent" : candidate.getPartyId();
-            cout << left << setw(10) << candidate.getId()
-                 << setw(20) << candidate.getName()
-                 << setw(25) << candidate.getCnic()
-                 << setw(12) << partyInfo << endl;
+        if (type == 'C') {
+            vector<BallotEntry> ballot;
+            engine.getBallot(connection.voterId, ballot);
+            string lines;
+            for (const auto& entry : ballot) {
+                lines += entry.id + "," + entry.name + "," + entry.party + "\n";
+            }
+            reply(connection, true, lines);
+        } else if (type == 'S') {
+            VoterStatus status;
+            engine.getVoterStatus(connection.voterId, status);
+            reply(connection, true, status.constituency + "," + (status.hasVoted ? "1" : "0") + "," + status.votedFor);
+        } else {
+            // State changes go to the workers
+            connection.busy = true;
+            lock_guard<mutex> lock(queueMutex);
+            tasks.push_back({fd, connection.serial, connection.voterId, string(body)});
+            taskReady.notify_one();
         }
     }
     
-    /*
-     * ===================================================================
-     * VOTER MANAGEMENT METHODS
-     * ===================================================================
-     */
+    // Answer the complete requests received so far; false if the
+    // connection was closed
+    bool processInput(int fd, Connection& connection) {
+        while (!connection.busy) {
+            char type;
+            string_view body;
+            bool malformed = false;
+            if (!nextFrame(connection.input, connection.consumed, type, body, malformed)) {
+                if (malformed) {
+                    closeConnection(fd);
+                    return false;
+                }
+                break;
+            }
+            handleRequest(fd, connection, type, body);
+        }
+        connection.input.erase(0, connection.consumed);
+        connection.consumed = 0;
+        return flushOutput(fd, connection);
+    }
     
-    void registerVoter() {
-        cout << "\n=== REGISTER VOTER ===" << endl;
-        
-        string username = getValidatedString("Username: ", 3, 20);
-        
-        // Check if username already exists
-        for (const auto& voter : voters.getAllData()) {
-            if (voter.getUsername() == username) {
-                cout << "Username already exists!" << endl;
+    void acceptConnections() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) break;
+            Connection& connection = connections[fd];
+            connection = Connection();
+            connection.serial = nextSerial++;
+            connection.events = EPOLLIN;
+            watch(fd, EPOLLIN, true);
+        }
+    }
+    
+    void readConnection(int fd, uint32_t events) {
+        auto it = connections.find(fd);
+        if (it == connections.end()) return;
+        Connection& connection = it->second;
+        if (events & EPOLLIN) {
+            char chunk[16384];
+            ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                closeConnection(fd);
                 return;
             }
-        }
-        
-        string password = getValidatedString("Password: ", 6, 20);
-        string name = getValidatedString("Full Name: ", 2, 50);
-        string id = generateVoterId();
-        
-        string cnic = getValidatedCNIC("CNIC");
-        
-        // Check if CNIC already exists
-        if (cnicExists(cnic)) {
-            cout << "CNIC already registered in the system!" << endl;
+            if (received > 0) connection.input.append(chunk, received);
+            if (!processInput(fd, connection)) return;
+        } else if (events & (EPOLLHUP | EPOLLERR)) {
+            closeConnection(fd);
             return;
         }
-        
-        voters.addData(Voter(username, password, name, id, cnic));
-        cout << "Voter registered successfully!" << endl;
+        if (events & EPOLLOUT) flushOutput(fd, connection);
     }
     
-    void viewAllVoters() {
-        cout << "\n=== ALL VOTERS ===" << endl;
-        if (voters.getSize() == 0) {
-            cout << "No voters registered." << endl;
-            return;
+    // Replies of finished votes; each connection reads its next requests
+    void deliverReplies() {
+        uint64_t count;
+        if (read(wakeFd, &count, sizeof(count)) < 0) { /* Already drained */ }
+        vector<VoteReply> finished;
+        {
+            lock_guard<mutex> lock(queueMutex);
+            finished.swap(replies);
         }
-        
-        cout << left << setw(15) << "Username" << setw(25) << "Name" << setw(25) << "CNIC" 
-             << setw(12) << "Voter ID" << setw(10) << "Voted" << endl;
-        cout << string(85, '-') << endl;
-        
-        for (const auto& voter : voters.getAllData()) {
-            cout << left << setw(15) << voter.getUsername()
-                 << setw(25) << voter.getName()
-                 << setw(25) << voter.getCnic()
-                 << setw(12) << voter.getId()
-                 << setw(10) << (voter.getHasVoted() ? "Yes" : "No") << endl;
+        for (auto& finishedVote : finished) {
+            auto it = connections.find(finishedVote.fd);
+            if (it == connections.end() || it->second.serial != finishedVote.serial) continue; // Client left
+            it->second.output += finishedVote.frame;
+            it->second.busy = false;
+            processInput(finishedVote.fd, it->second);
         }
     }
     
-    /*
-     * ===================================================================
-     * VOTING METHODS
-     * ===================================================================
-     */
+    void workerLoop() {
+        unique_lock<mutex> lock(queueMutex);
+        while (true) {
+            taskReady.wait(lock, [&]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            VoteTask task = move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            VoteResult result = engine.submitVote(task.voterId, task.candidateId);
+            string frame;
+            appendFrame(frame, result == VoteResult::SUCCESS ? 'O' : 'E', voteResultText(result));
+            lock.lock();
+            if (replies.empty()) {
+                uint64_t one = 1;
+                if (write(wakeFd, &one, sizeof(one)) < 0) { /* Counter is already set */ }
+            }
+            replies.push_back({task.fd, task.serial, move(frame)});
+        }
+    }
+
+public:
+    KioskServer(ElectionEngine& e, const string& path, unsigned threads = 0) 
+        : engine(e), socketPath(path), workerCount(threads > 0 ? threads : max(1u, thread::hardware_concurrency())),
+          listenFd(-1), epollFd(-1), wakeFd(-1), stopFd(-1), nextSerial(1), stopping(false) {}
     
-    void castVote(Voter* voter) {
-        if (!timer.isElectionActive()) {
-            cout << "Election is not currently active!" << endl;
-            cout << "Status: " << timer.getStatus() << endl;
-            return;
+    ~KioskServer() {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            stopping = true;
         }
-        
-        if (voter->getHasVoted()) {
-            cout << "You have already voted!" << endl;
-            cout << "You voted for candidate: " << voter->getVotedFor() << endl;
-            return;
+        taskReady.notify_all();
+        for (auto& worker : workers) worker.join();
+        for (auto& entry : connections) close(entry.first);
+        for (int fd : {listenFd, epollFd, wakeFd, stopFd}) {
+            if (fd >= 0) close(fd);
         }
-        
-        if (candidates.getSize() == 0) {
-            cout << "No candidates available for voting." << endl;
-            return;
+        if (listenFd >= 0) unlink(socketPath.c_str());
+    }
+    
+    // Bind the socket and start the workers; false (with a message) if
+    // the socket cannot be used
+    bool start() {
+        sockaddr_un address;
+        if (!fillSocketAddress(socketPath, address)) {
+            cout << "Invalid socket path '" << socketPath << "'" << endl;
+            return false;
         }
-        
-        cout << "\n=== CAST VOTE ===" << endl;
-        cout << "Available Candidates:" << endl;
-        cout << left << setw(10) << "ID" << setw(20) << "Name" << setw(15) << "Party/Type" << endl;
-        cout << string(45, '-') << endl;
-        
-        for (const auto& candidate : candidates.getAllData()) {
-            string partyInfo = candidate.getIsIndependent() ? "Independent" : candidate.getPartyId();
-            cout << left << setw(10) << candidate.getId()
-                 << setw(20) << candidate.getName()
-                 << setw(15) << partyInfo << endl;
+        // Never take over the socket of a running server; remove a stale one
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool inUse = connect(probe, (sockaddr*)&address, sizeof(address)) == 0;
+        close(probe);
+        if (inUse) {
+            cout << "A server is already listening on '" << socketPath << "'" << endl;
+            return false;
         }
+        unlink(socketPath.c_str());
         
-        string candidateId = getValidatedString("Enter Candidate ID to vote for: ");
-        
-        // Find and validate candidate
-        bool candidateFound = false;
-        for (auto& candidate : candidates.getAllData()) {
-            if (candidate.getId() == candidateId) {
-                candidateFound = true;
-                
-                // Confirm vote
-                cout << "You are about to vote for: " << candidate.getName() << endl;
-                cout << "Are you sure? (y/n): ";
-                char confirm;
-                cin >> confirm;
-                cin.ignore();
-                
-                if (confirm == 'y' || confirm == 'Y') {
-                    // Cast vote
-                    candidate.addVote();
-                    voter->castVote(candidateId);
-                    
-                    // Update party votes if candidate belongs to a party
-                    if (!candidate.getIsIndependent()) {
-                        for (auto& party : parties.getAllData()) {
-                            if (party.getId() == candidate.getPartyId()) {
-                                party.setTotalVotes(party.getTotalVotes() + 1);
-                                break;
-                            }
-                        }
-                    }
-                    
-                    cout << "Vote cast successfully!" << endl;
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0 || ::bind(listenFd, (sockaddr*)&address, sizeof(address)) < 0 || 
+            listen(listenFd, SOMAXCONN) < 0) {
+            cout << "Cannot listen on '" << socketPath << "': " << strerror(errno) << endl;
+            if (listenFd >= 0) close(listenFd);
+            listenFd = -1;
+            return false;
+        }
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        watch(listenFd, EPOLLIN, true);
+        watch(wakeFd, EPOLLIN, true);
+        watch(stopFd, EPOLLIN, true);
+        for (unsigned t = 0; t < workerCount; t++) {
+            workers.emplace_back(&KioskServer::workerLoop, this);
+        }
+        return true;
+    }
+    
+    // Serve until stop() is called or 'signalFd' (a signalfd) is readable
+    void run(int signalFd = -1) {
+        if (signalFd >= 0) watch(signalFd, EPOLLIN, true);
+        vector<epoll_event> events(1024);
+        bool running = true;
+        while (running) {
+            int count = epoll_wait(epollFd, events.data(), (int)events.size(), -1);
+            if (count < 0 && errno == EINTR) continue;
+            if (count < 0) break;
+            for (int i = 0; i < count; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    acceptConnections();
+                } else if (fd == wakeFd) {
+                    deliverReplies();
+                } else if (fd == stopFd || fd == signalFd) {
+                    running = false;
                 } else {
-                    cout << "Vote cancelled." << endl;
+                    readConnection(fd, events[i].events);
                 }
-                break;
             }
         }
-        
-        if (!candidateFound) {
-            cout << "Invalid candidate ID!" << endl;
-        }
     }
     
-    /*
-     * ===================================================================
-     * ELECTION TIMING METHODS
-     * ===================================================================
-     */
-    
-    void setElectionTiming() {
-        cout << "\n=== SET ELECTION TIMING ===" << endl;
-        
-        time_t currentTime = time(0);
-        cout << "Current time: " << ctime(&currentTime);
-        
-        time_t startTime = getValidatedDateTime("Enter election start time");
-        time_t endTime = getValidatedDateTime("Enter election end time");
-        
-        if (endTime <= startTime) {
-            cout << "End time must be after start time!" << endl;
-            return;
-        }
-        
-        timer.setTiming(startTime, endTime);
-        cout << "Election timing set successfully!" << endl;
-        
-        cout << "Election Start: " << ctime(&startTime);
-        cout << "Election End: " << ctime(&endTime);
+    // Safe from any thread
+    void stop() {
+        uint64_t one = 1;
+        if (write(stopFd, &one, sizeof(one)) < 0) { /* Already stopping */ }
     }
     
-    void viewElectionStatus() {
-        cout << "\n=== ELECTION STATUS ===" << endl;
-        cout << "Status: " << timer.getStatus() << endl;
-        
-        if (timer.isTimingSet()) {
-            time_t start = timer.getStartTime();
-            time_t end = timer.getEndTime();
-            cout << "Start Time: " << ctime(&start);
-            cout << "End Time: " << ctime(&end);
-        }
-        
-        cout << "Total Registered Voters: " << voters.getSize() << endl;
-        cout << "Total Candidates: " << candidates.getSize() << endl;
-        cout << "Total Parties: " << parties.getSize() << endl;
-        
-        // Count votes cast
-        int votesCast = 0;
-        for (const auto& voter : voters.getAllData()) {
-            if (voter.getHasVoted()) votesCast++;
-        }
-        cout << "Votes Cast: " << votesCast << endl;
-        
-        if (voters.getSize() > 0) {
-            double turnout = (double)votesCast / voters.getSize() * 100;
-            cout << "Voter Turnout: " << fixed << setprecision(2) << turnout << "%" << endl;
-        }
+    long long getRequestCount() const { return requestCount; }
+    size_t getConnectionCount() const { return connections.size(); }
+};
+
+// Blocking client of the kiosk server (one request at a time)
+class KioskClient {
+private:
+    int fd;
+    string buffer;
+
+public:
+    KioskClient() : fd(-1) {}
+    ~KioskClient() {
+        if (fd >= 0) close(fd);
     }
     
-    /*
-     * ===================================================================
-     * ELECTION REPORT GENERATION
-     * ===================================================================
-     */
+    bool connectTo(const string& socketPath) {
+        sockaddr_un address;
+        if (!fillSocketAddress(socketPath, address)) return false;
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        return fd >= 0 && connect(fd, (sockaddr*)&address, sizeof(address)) == 0;
+    }
     
-    void generateElectionReport() {
-        cout << "\n=== ELECTION REPORT ===" << endl;
-        
-        if (!timer.hasElectionEnded()) {
-        cout << "Election is still ongoing. Report will be available after election ends." << endl;
-        return;
+    // Send one request and wait for its reply; false if the connection is lost
+    bool request(char type, const string& body, bool& success, string& reply) {
+        string frame;
+        appendFrame(frame, type, body);
+        for (size_t sent = 0; sent < frame.size(); ) {
+            ssize_t written = send(fd, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+            if (written <= 0) return false;
+            sent += written;
         }
-        
-        // Count total votes
-        int totalVotes = 0;
-        for (const auto& candidate : candidates.getAllData()) {
-            totalVotes += candidate.getVotes();
+        while (true) {
+            size_t offset = 0;
+            char status;
+            string_view payload;
+            bool malformed = false;
+            if (nextFrame(buffer, offset, status, payload, malformed)) {
+                success = status == 'O';
+                reply = string(payload);
+                buffer.erase(0, offset);
+                return true;
+            }
+            char chunk[16384];
+            ssize_t received = malformed ? -1 : recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0) return false;
+            buffer.append(chunk, received);
         }
+    }
+};
+
+// Serve the data files of 'options' until SIGINT or SIGTERM
+int runKioskServer(const SystemOptions& options, const string& socketPath, unsigned workerCount) {
+    // Blocked before any thread starts, so only the signalfd sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    int signalFd = signalfd(-1, &signals, SFD_CLOEXEC);
+    raiseFileLimit();
+    
+    ElectionEngine engine(options, &cerr);
+    KioskServer server(engine, socketPath, workerCount);
+    if (!server.start()) return 1;
+    cout << "Kiosk server listening on '" << socketPath << "' (Ctrl+C to stop)" << endl;
+    server.run(signalFd);
+    cout << "Kiosk server stopped after " << server.getRequestCount() << " requests; saving data..." << endl;
+    close(signalFd);
+    return 0;
+}
+
+// Voter terminal: every voter session gets its own connection
+void runKioskClient(const string& socketPath) {
+    cout << "\n=== VOTING KIOSK ===" << endl;
+    while (true) {
+        cout << "\n1. Login as Voter" << endl;
+        cout << "2. Exit" << endl;
+        if (VotingSystem::getValidatedInt("Enter your choice: ", 1, 2) == 2) return;
         
-        if (totalVotes == 0) {
-            cout << "No votes have been cast yet." << endl;
+        KioskClient client;
+        if (!client.connectTo(socketPath)) {
+            cout << "Cannot connect to the server at '" << socketPath << "'" << endl;
             return;
         }
-        
-        // Sort candidates by votes (using STL algorithm)
-        vector<Candidate> sortedCandidates = candidates.getAllData();
-        sort(sortedCandidates.begin(), sortedCandidates.end(),
-             [](const Candidate& a, const Candidate& b) {
-                 return a.getVotes() > b.getVotes();
-             });
-        
-        cout << "\n=== CANDIDATE RESULTS (Sorted by Votes) ===" << endl;
-        cout << left << setw(5) << "Rank" << setw(10) << "ID" << setw(20) << "Name" 
-             << setw(15) << "Party/Type" << setw(8) << "Votes" << setw(12) << "Percentage" << endl;
-        cout << string(70, '-') << endl;
-        
-        for (size_t i = 0; i < sortedCandidates.size(); i++) {
-            const auto& candidate = sortedCandidates[i];
-            string partyInfo = candidate.getIsIndependent() ? "Independent" : candidate.getPartyId();
-            double percentage = (double)candidate.getVotes() / totalVotes * 100;
-            
-            cout << left << setw(5) << (i + 1)
-                 << setw(10) << candidate.getId()
-                 << setw(20) << candidate.getName()
-                 << setw(15) << partyInfo
-                 << setw(8) << candidate.getVotes()
-                 << setw(12) << fixed << setprecision(1) << percentage << "%" << endl;
+        string username = VotingSystem::getValidatedString("Username: ");
+        string password = VotingSystem::getHiddenPassword("Password: ");
+        bool success;
+        string reply;
+        if (!client.request('L', username + "," + password, success, reply)) {
+            cout << "Connection to the server lost." << endl;
+            return;
         }
-        
-        // Party-wise results
-        if (parties.getSize() > 0) {
-            cout << "\n=== PARTY-WISE RESULTS ===" << endl;
-            
-            // Sort parties by votes
-            vector<Party> sortedParties = parties.getAllData();
-            sort(sortedParties.begin(), sortedParties.end(),
-                 [](const Party& a, const Party& b) {
-                     return a.getTotalVotes() > b.getTotalVotes();
-                 });
-            
-            cout << left << setw(5) << "Rank" << setw(10) << "ID" << setw(25) << "Name" 
-                 << setw(8) << "Votes" << setw(12) << "Percentage" << endl;
-            cout << string(60, '-') << endl;
-            
-            for (size_t i = 0; i < sortedParties.size(); i++) {
-                const auto& party = sortedParties[i];
-                double percentage = (double)party.getTotalVotes() / totalVotes * 100;
-                
-                cout << left << setw(5) << (i + 1)
-                     << setw(10) << party.getId()
-                     << setw(25) << party.getName()
-                     << setw(8) << party.getTotalVotes()
-                     << setw(12) << fixed << setprecision(1) << percentage << "%" << endl;
-            }
+        if (!success) {
+            cout << reply << "!" << endl;
+            continue;
         }
+        cout << "Voter login successful! (Voter ID: " << reply << ")" << endl;
         
-        // Winner announcement - handle ties
-        if (!sortedCandidates.empty()) {
-            const auto& topCandidate = sortedCandidates[0];
-            
-            // Check for ties
-            vector<Candidate> winners;
-            for (const auto& candidate : sortedCandidates) {
-                if (candidate.getVotes() == topCandidate.getVotes()) {
-                    winners.push_back(candidate);
-                } else {
-                    break; // Since sorted, no more ties
+        bool loggedIn = true;
+        while (loggedIn) {
+            cout << "\n=== VOTER MENU ===" << endl;
+            cout << "1. View Candidates" << endl;
+            cout << "2. Cast Vote" << endl;
+            cout << "3. Check Voting Status" << endl;
+            cout << "4. Logout" << endl;
+            int choice = VotingSystem::getValidatedInt("Enter your choice: ", 1, 4);
+            bool connected = true;
+            if (choice == 1 || choice == 2) {
+                connected = client.request('C', "", success, reply);
+                if (connected) {
+                    cout << left << setw(10) << "ID" << setw(20) << "Name" << setw(15) << "Party/Type" << endl;
+                    cout << string(45, '-') << endl;
+                    istringstream lines(reply);
+                    string line;
+                    while (getline(lines, line)) {
+                        FieldTokenizer fields(line);
+                        string id(fields.next()), name(fields.next()), party(fields.next());
+                        cout << left << setw(10) << id << setw(20) << name << setw(15) << party << endl;
+                    }
                 }
             }
-            
-            cout << "\n=== ELECTION RESULT ===" << endl;
-            if (winners.size() == 1) {
-                cout << "Winner: " << winners[0].getName() << " (ID: " << winners[0].getId() << ")" << endl;
-                cout << "Votes: " << winners[0].getVotes() << " (" 
-                    << fixed << setprecision(1) << (double)winners[0].getVotes() / totalVotes * 100 << "%)" << endl;
-                
-                if (!winners[0].getIsIndependent()) {
-                    cout << "Party: " << winners[0].getPartyId() << endl;
+            if (connected && choice == 2) {
+                string candidateId = VotingSystem::getValidatedString("Enter Candidate ID to vote for: ");
+                cout << "Are you sure? (y/n): ";
+                char confirm;
+                cin >> confirm;
+                cin.ignore();
+                if (confirm == 'y' || confirm == 'Y') {
+                    connected = client.request('V', candidateId, success, reply);
+                    if (connected) cout << (success ? "Vote cast successfully!" : reply + "!") << endl;
                 } else {
-                    cout << "Independent Candidate" << endl;
+                    cout << "Vote cancelled." << endl;
                 }
-            } else {
-                cout << "TIE RESULT - " << winners.size() << " candidates tied with " << topCandidate.getVotes() << " votes each:" << endl;
-                for (const auto& winner : winners) {
-                    cout << "- " << winner.getName() << " (ID: " << winner.getId() << ")";
-                    if (!winner.getIsIndependent()) {
-                        cout << " (Party: " << winner.getPartyId() << ")";
-                    } else {
-                        cout << " (Independent)";
-                    }
-                    cout << endl;
+            } else if (choice == 3) {
+                connected = client.request('S', "", success, reply);
+                if (connected) {
+                    FieldTokenizer fields(reply);
+                    string constituency(fields.next()), hasVoted(fields.next()), votedFor(fields.next());
+                    cout << "\n=== VOTING STATUS ===" << endl;
+                    cout << "Constituency: " << constituency << endl;
+                    cout << "Has Voted: " << (hasVoted == "1" ? "Yes" : "No") << endl;
+                    if (hasVoted == "1") cout << "Voted For: " << votedFor << endl;
                 }
-                cout << "A runoff election may be required." << endl;
-            }
-        }
-        
-        // Save report to file
-        saveReportToFile(sortedCandidates, totalVotes);
-    }
-    
-    void saveReportToFile(const vector<Candidate>& sortedCandidates, int totalVotes) {
-        ofstream reportFile("election_report.txt");
-        if (reportFile.is_open()) {
-            time_t currentTime = time(0);
-            reportFile << "ELECTION REPORT - Generated on: " << ctime(&currentTime) << endl;
-            reportFile << string(50, '=') << endl;
-            
-            reportFile << "Total Votes Cast: " << totalVotes << endl;
-            reportFile << "Total Candidates: " << candidates.getSize() << endl;
-            reportFile << "Total Parties: " << parties.getSize() << endl;
-            
-            reportFile << "\nCANDIDATE RESULTS:" << endl;
-            for (size_t i = 0; i < sortedCandidates.size(); i++) {
-                const auto& candidate = sortedCandidates[i];
-                double percentage = (double)candidate.getVotes() / totalVotes * 100;
-                reportFile << (i + 1) << ". " << candidate.getName() 
-                          << " - " << candidate.getVotes() << " votes (" 
-                          << fixed << setprecision(1) << percentage << "%)" << endl;
+            } else if (choice == 4) {
+                cout << "Logging out..." << endl;
+                loggedIn = false;
             }
-            
-            if (!sortedCandidates.empty()) {
-                const auto& winner = sortedCandidates[0];
-                reportFile << "\nWINNER: " << winner.getName() << endl;
+            if (!connected) {
+                cout << "Connection to the server lost." << endl;
+                return;
             }
-            
-            reportFile.close();
-            cout << "\nReport saved to 'election_report.txt'" << endl;
         }
     }
+}
+
+// Closed-loop load: each connection runs login, candidates, vote and
+// status for one synthetic voter after another, with one request
+// outstanding, for 'seconds'. Returns false if it could not connect.
+bool runKioskLoad(const string& socketPath, int connectionCount, long long voterCount, long long& nextVoter, 
+                  double seconds) {
+    struct Session {
+        int fd = -1;
+        int step = 0;          // 0 login, 1 candidates, 2 vote, 3 status
+        long long voter = 0;
+        string input, candidateId;
+        chrono::steady_clock::time_point sent;
+    };
+    vector<Session> sessions(connectionCount);
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    int connected = 0;
+    for (auto& session : sessions) {
+        sockaddr_un address;
+        fillSocketAddress(socketPath, address);
+        session.fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (session.fd < 0 || connect(session.fd, (sockaddr*)&address, sizeof(address)) < 0) break;
+        fcntl(session.fd, F_SETFL, O_NONBLOCK);
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u32 = connected++;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, session.fd, &event);
+    }
     
-    /*
-     * ===================================================================
-     * MAIN SYSTEM CONTROL METHODS
-     * ===================================================================
-     */
-    
-    void runSystem() {
-        cout << "\n=== ELECTRONIC VOTING SYSTEM ===" << endl;
-        cout << "Welcome to the Digital Democracy Platform" << endl;
-    
-        while (true) {
-        cout << "\n=== DIGITAL VOTING SYSTEM ===" << endl;
-        cout << "1. Login as Admin" << endl;
-        cout << "2. Login as Voter" << endl;
-        cout << "3. Check Election Results (Public)" << endl;
-        cout << "4. Exit" << endl;
-    
-        int choice = getValidatedInt("Enter your choice: ", 1, 4);
-    
-        switch (choice) {
-            case 1:
-            case 2:
-                currentUser = login();
-                if (currentUser != nullptr) {
-                    handleUserSession();
-                }
-                break;
-            case 3:
-                generateElectionReport();
-                break;
-            case 4:
-                cout << "Thank you for using the Digital Voting System!" << endl;
-                return;
+    auto sendNext = [&](Session& session) {
+        string frame;
+        if (session.step == 0) {
+            session.voter = nextVoter++ % voterCount;
+            appendFrame(frame, 'L', "user" + to_string(session.voter) + ",pass" + to_string(session.voter));
+        } else {
+            appendFrame(frame, "CVS"[session.step - 1], session.step == 2 ? session.candidateId : "");
         }
-    }
-}
+        session.sent = chrono::steady_clock::now();
+        if (send(session.fd, frame.data(), frame.size(), MSG_NOSIGNAL) < 0) { /* Seen as a missing reply */ }
+    };
     
-    void handleUserSession() {
-        while (currentUser != nullptr) {
-            currentUser->displayMenu();
-            
-            // Check if admin or voter
-            Admin* adminPtr = dynamic_cast<Admin*>(currentUser);
-            Voter* voterPtr = dynamic_cast<Voter*>(currentUser);
-            
-            if (adminPtr) {
-                handleAdminMenu();
-            } else if (voterPtr) {
-                handleVoterMenu(voterPtr);
+    LatencyRecorder latency("requests");
+    auto start = chrono::steady_clock::now();
+    auto deadline = start + chrono::duration<double>(seconds);
+    if (connected == connectionCount) {
+        for (auto& session : sessions) sendNext(session);
+        vector<epoll_event> events(1024);
+        while (chrono::steady_clock::now() < deadline) {
+            int count = epoll_wait(epollFd, events.data(), (int)events.size(), 100);
+            for (int i = 0; i < count; i++) {
+                Session& session = sessions[events[i].data.u32];
+                char chunk[16384];
+                ssize_t received = recv(session.fd, chunk, sizeof(chunk), 0);
+                if (received <= 0) continue;
+                session.input.append(chunk, received);
+                size_t offset = 0;
+                char status;
+                string_view body;
+                bool malformed = false;
+                if (!nextFrame(session.input, offset, status, body, malformed)) continue;
+                auto now = chrono::steady_clock::now();
+                latency.add(chrono::duration<double, micro>(now - session.sent).count());
+                if (session.step == 1) session.candidateId = string(body.substr(0, body.find(',')));
+                session.input.erase(0, offset);
+                session.step = (session.step + 1) % 4;
+                sendNext(session);
             }
         }
     }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    for (auto& session : sessions) {
+        if (session.fd >= 0) close(session.fd);
+    }
+    close(epollFd);
+    if (connected < connectionCount) {
+        cout << left << setw(13) << connectionCount << "only " << connected << " connections could be opened" << endl;
+        return false;
+    }
+    cout << left << setw(13) << connectionCount << right << setw(10) << latency.count() << setw(12) << fixed 
+         << setprecision(0) << latency.count() / elapsed << setprecision(1) << setw(12) << latency.percentile(50) 
+         << setw(12) << latency.percentile(99) << setw(12) << latency.percentile(100) << endl;
+    return true;
+}
+
+// Requests per second of the kiosk server for each connection count;
+// the server runs in a child process with its own descriptor limit
+void runServerBenchmark(long long voterCount, const vector<int>& connectionCounts, double seconds = 3) {
+    const string directory = "bench_server_data";
+    const string socketPath = directory + "/kiosk.sock";
+    filesystem::remove_all(directory);
+    generateSyntheticData(directory, voterCount, 20, 5);
+    raiseFileLimit();
     
-    void handleAdminMenu() {
-        int choice = getValidatedInt("Enter your choice: ", 1, 9);
-        
-        switch (choice) {
-            case 1: manageParties(); break;
-            case 2: addCandidate(); break;
-            case 3: viewAllCandidates(); break;
-            case 4: registerVoter(); break;
-            case 5: viewAllVoters(); break;
-            case 6: setElectionTiming(); break;
-            case 7: viewElectionStatus(); break;
-            case 8: generateElectionReport(); break;
-            case 9: 
-                cout << "Logging out..." << endl;
-                currentUser = nullptr;
-                break;
+    int ready[2];
+    if (pipe(ready) < 0) return;
+    pid_t child = fork();
+    if (child == 0) {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+        int signalFd = signalfd(-1, &signals, SFD_CLOEXEC);
+        {
+            SystemOptions options;
+            options.dataDirectory = directory;
+            ElectionEngine engine(options);
+            engine.setElectionWindow(time(0) - 60, time(0) + 3600);
+            KioskServer server(engine, socketPath);
+            char started = server.start() ? 1 : 0;
+            if (write(ready[1], &started, 1) == 1 && started) server.run(signalFd);
         }
+        _exit(0);
     }
+    char started = 0;
+    if (read(ready[0], &started, 1) != 1) started = 0;
+    close(ready[0]);
+    close(ready[1]);
     
-    void handleVoterMenu(Voter* voter) {
-        int choice = getValidatedInt("Enter your choice: ", 1, 5);
-        
-        switch (choice) {
-            case 1: viewAllCandidatesForVoter(); break;
-            case 2: viewAllParties(); break;
-            case 3: castVote(voter); break;
-            case 4: 
-                cout << "\n=== VOTING STATUS ===" << endl;
-                cout << "Has Voted: " << (voter->getHasVoted() ? "Yes" : "No") << endl;
-                if (voter->getHasVoted()) {
-                    cout << "Voted For: " << voter->getVotedFor() << endl;
-                }
-                break;
-            case 5:
-                cout << "Logging out..." << endl;
-                currentUser = nullptr;
-                break;
+    if (started) {
+        cout << "\n=== Kiosk server: " << voterCount << " voters, " << seconds << " s per run ===" << endl;
+        cout << left << setw(13) << "Connections" << right << setw(10) << "Requests" << setw(12) << "req/sec" 
+             << setw(12) << "p50 (us)" << setw(12) << "p99 (us)" << setw(12) << "max (us)" << endl;
+        cout << string(71, '-') << endl;
+        long long nextVoter = 0;
+        for (int connections : connectionCounts) {
+            runKioskLoad(socketPath, connections, voterCount, nextVoter, seconds);
         }
     }
-};
+    kill(child, SIGTERM);
+    waitpid(child, nullptr, 0);
+    filesystem::remove_all(directory);
+}
+#endif
 
-/*
- * ===================================================================
- * MAIN FUNCTION - ENTRY POINT OF THE PROGRAM
- * ===================================================================
- */
-int main() {
+int main(int argc, char* argv[]) {
+    // Optional command-line settings
+    SystemOptions options;
+    string serveSocket; // --serve: started once every option is read
+    unsigned serveWorkers = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--commit-window" && i + 1 < argc) {
+            if (!parseOption(arg, argv[++i], options.journalCommitWindowMs)) return 1;
+        } else if (arg == "--save-interval" && i + 1 < argc) {
+            if (!parseOption(arg, argv[++i], options.saveIntervalMs)) return 1;
+        } else if (arg == "--metrics-interval" && i + 1 < argc) {
+            if (!parseOption(arg, argv[++i], options.metricsIntervalMs)) return 1;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceLog.start(argv[++i]); // Written at exit
+        } else if (arg == "--journal-queue" && i + 1 < argc) {
+            if (!parseOption(arg, argv[++i], options.journalQueueRecords)) return 1;
+        } else if (arg == "--verify-ids") {
+            options.verifyIdCounters = true;
+        } else if (arg == "--lazy") {
+            options.lazyVoters = true;
+        } else if (arg == "--binary") {
+            options.binarySnapshots = true;
+        } else if (arg == "--data-dir" && i + 1 < argc) {
+            options.dataDirectory = argv[++i];
+        } else if (arg == "--generate" && i + 1 < argc) {
+            // Synthetic data set: --generate <voters> [candidates] [parties] [constituencies]
+            long long voterCount = 0;
+            if (!parseOption(arg, argv[++i], voterCount)) return 1;
+            int candidateCount = 20, partyCount = 5, constituencyCount = 1;
+            parseOptionalNumber(argc, argv, i, candidateCount);
+            parseOptionalNumber(argc, argv, i, partyCount);
+            parseOptionalNumber(argc, argv, i, constituencyCount);
+            generateSyntheticData(options.dataDirectory, voterCount, candidateCount, partyCount, constituencyCount);
+            cout << "Generated " << voterCount << " voters, " << candidateCount << " candidates and " 
+                 << partyCount << " parties in " << max(1, constituencyCount) << " constituencies" << endl;
+            return 0;
+        } else if (arg == "--simulate" && i + 1 < argc) {
+            // --simulate <sessions> [rates] [terminals] [script-file]
+            int sessionCount = 0;
+            if (!parseOption(arg, argv[++i], sessionCount)) return 1;
+            vector<int> rateList;
+            string list = i + 1 < argc ? argv[++i] : "250,500,1000,2000,4000,8000,16000";
+            if (!parseNumberList(list, rateList)) {
+                cout << "Invalid rates: " << list << endl;
+                return 1;
+            }
+            vector<double> rates(rateList.begin(), rateList.end());
+            unsigned terminals = 16;
+            parseOptionalNumber(argc, argv, i, terminals);
+            string scriptFile = (i + 1 < argc) ? argv[++i] : "";
+            runLoadSimulation(sessionCount, rates, terminals, scriptFile);
+            return 0;
+        } else if (arg == "--bench") {
+            // Comma-separated voter-roll sizes, e.g. --bench 1000,100000,10000000
+            vector<long long> sizes;
+            string list = i + 1 < argc ? argv[++i] : "1000,10000,100000,1000000";
+            if (!parseNumberList(list, sizes)) {
+                cout << "Invalid voter-roll sizes: " << list << endl;
+                return 1;
+            }
+            runBenchmarkSuite(sizes);
+            return 0;
+        } else if (arg == "--bench-load" && i + 1 < argc) {
+            long long rows = 0;
+            unsigned threads = 0;
+            if (!parseOption(arg, argv[++i], rows)) return 1;
+            parseOptionalNumber(argc, argv, i, threads);
+            runLoadBenchmark(rows, threads);
+            return 0;
+        } else if (arg == "--bench-memory" && i + 1 < argc) {
+            long long rows = 0;
+            if (!parseOption(arg, argv[++i], rows)) return 1;
+            runMemoryBenchmark(rows);
+            return 0;
+        } else if (arg == "--bench-sessions") {
+            int sessionCount = 10000;
+            parseOptionalNumber(argc, argv, i, sessionCount);
+            runSessionBenchmark(sessionCount);
+            return 0;
+        } else if (arg == "--bench-cnic") {
+            long long count = 10000000;
+            parseOptionalNumber(argc, argv, i, count);
+            runCnicBenchmark(count);
+            return 0;
+        } else if (arg == "--bench-scan") {
+            // Comma-separated row counts of the synthetic voters.txt
+            vector<long long> rowCounts;
+            string list = i + 1 < argc ? argv[++i] : "1000000,10000000";
+            if (!parseNumberList(list, rowCounts)) {
+                cout << "Invalid row counts: " << list << endl;
+                return 1;
+            }
+            for (size_t r = 0; r < rowCounts.size(); r++) {
+                if (r > 0) cout << endl;
+                runScanBenchmark(rowCounts[r]);
+            }
+            return 0;
+        } else if (arg == "--bench-report") {
+            int candidateCount = 100000;
+            parseOptionalNumber(argc, argv, i, candidateCount);
+            runReportBenchmark(candidateCount);
+            return 0;
+        } else if (arg == "--fuzz-cnic") {
+            // --fuzz-cnic [inputs] [seed]
+            long long iterations = 10000000;
+            uint64_t seed = (uint64_t)time(0);
+            parseOptionalNumber(argc, argv, i, iterations);
+            parseOptionalNumber(argc, argv, i, seed);
+            return runCnicFuzz(iterations, seed) ? 0 : 1;
+        } else if (arg == "--stress-votes" && i + 1 < argc) {
+            int voterCount = 0;
+            unsigned threads = 0;
+            if (!parseOption(arg, argv[++i], voterCount)) return 1;
+            parseOptionalNumber(argc, argv, i, threads);
+            return runVoteStressTest(voterCount, threads) ? 0 : 1;
+        } else if (arg == "--ingest" && i + 1 < argc) {
+            // Headless ballot import into the data files of the current directory
+            string ballotFile = argv[++i];
+            string rejectsFile = (i + 1 < argc) ? argv[++i] : ballotFile + ".rejects.txt";
+            ElectionEngine system(options, &cerr);
+            VotingSystem::printImportSummary(system.ingestBallots(ballotFile, rejectsFile), rejectsFile);
+            return 0;
+        } else if (arg == "--batch" && i + 1 < argc) {
+            // Headless command file: --batch <commands> [results-file]
+            string commandFile = argv[++i];
+            string resultsFile = (i + 1 < argc) ? argv[++i] : commandFile + ".results.txt";
+            ElectionEngine system(options, &cerr);
+            BallotImportSummary summary = system.runBatch(commandFile, resultsFile);
+            VotingSystem::printBatchSummary(summary, resultsFile);
+            return summary.error.empty() ? 0 : 1;
+#ifdef __linux__
+        } else if (arg == "--serve" && i + 1 < argc) {
+            // Kiosk server: --serve <socket> [workers]; a worker count is
+            // only taken if the next argument is a number
+            serveSocket = argv[++i];
+            parseOptionalNumber(argc, argv, i, serveWorkers);
+        } else if (arg == "--client" && i + 1 < argc) {
+            runKioskClient(argv[++i]);
+            return 0;
+        } else if (arg == "--bench-server") {
+            // --bench-server [voters] [connection counts]
+            long long voterCount = 200000;
+            parseOptionalNumber(argc, argv, i, voterCount);
+            vector<int> counts;
+            string list = i + 1 < argc ? argv[++i] : "1,100,10000";
+            if (!parseNumberList(list, counts)) {
+                cout << "Invalid connection counts: " << list << endl;
+                return 1;
+            }
+            runServerBenchmark(voterCount, counts);
+            return 0;
+#endif
+        } else if (arg == "--convert-to-bin" || arg == "--convert-to-txt") {
+            convertDataFiles(options, arg == "--convert-to-bin");
+            return 0;
+        }
+    }
+#ifdef __linux__
+    if (!serveSocket.empty()) return runKioskServer(options, serveSocket, serveWorkers);
+#endif
+    
     // try {
-        VotingSystem system;
+        VotingSystem system(options);
         system.runSystem();
     // } catch (const exception& e) {
     //     cout << "System Error: " << e.what() << endl;
@@ -1390,4 +8936,4 @@ int main() {
     // }
     
     return 0;
-}
\ No newline at end of file
+}